@@ -0,0 +1,297 @@
+#!/usr/bin/env python3
+"""
+bench.py -- run espresso over the bundled PLA corpus and track performance
+
+Every PLA under examples/examples, examples/hard_examples and examples/tlex
+(including tlex/o64.pla, which is too slow for the ctest suite) is minimized
+--repeat times.  For each PLA we record the median and minimum wall time,
+the peak resident set size of the espresso process, and the number of cubes
+and literals in the result.  Literals are counted the way espresso's
+cover_cost() does: input literals plus ones in the output part.
+
+The peak RSS is measured exactly when --peakrss gives the peakrss program
+(built with the other bench tools).  Otherwise, on Linux it is sampled from
+/proc every millisecond; a run which ends before the first sample gets the
+ru_maxrss of wait4(), which also counts the image of this interpreter that
+the child was forked from, so it is only an upper bound.
+
+The results are written as a JSON report.  When a baseline report is given,
+each PLA is compared against it: a run is a regression if its median time
+exceeds the baseline by more than --tolerance (and by more than --min-delta
+seconds, so that noise on tiny PLAs is ignored), or if the cover got larger.
+The exit status is 1 if any regression was found.
+
+With --gen, synthetic PLAs made by plagen are benchmarked as well (or
+instead of the corpus, with --no-corpus); each --gen takes the plagen
+arguments, e.g. --gen "-m add -i 16 -o 9".  They are reported as
+"gen/<arguments>", so scaling series can be compared across reports.
+"""
+
+import argparse
+import json
+import os
+import platform
+import re
+import signal
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+CORPUS_DIRS = ("examples", "hard_examples", "tlex")
+HAVE_PROC = os.path.exists("/proc/self/status")
+
+
+def find_plas(corpus, pattern):
+    """Return (name, path) of the corpus PLAs matching pattern."""
+    plas = []
+    for d in CORPUS_DIRS:
+        path = os.path.join(corpus, d)
+        if not os.path.isdir(path):
+            continue
+        for name in sorted(os.listdir(path)):
+            rel = d + "/" + name
+            if (os.path.isfile(os.path.join(path, name)) and
+                    re.search(pattern, rel)):
+                plas.append((rel, os.path.join(path, name)))
+    return plas
+
+
+def generate_plas(plagen, specs, tmpdir):
+    """Run plagen once per spec; return (name, path) of the results."""
+    plas = []
+    for i, spec in enumerate(specs):
+        path = os.path.join(tmpdir, "gen%d.pla" % i)
+        with open(path, "wb") as fout:
+            subprocess.run([plagen] + spec.split(), stdout=fout, check=True)
+        plas.append(("gen/" + " ".join(spec.split()), path))
+    return plas
+
+
+def cover_size(text):
+    """Return (cubes, literals) of a minimized PLA in .type f format."""
+    ninputs = None
+    cubes = literals = 0
+    for line in text.splitlines():
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        if line.startswith("."):
+            words = line.split()
+            if words[0] == ".i":
+                ninputs = int(words[1])
+            continue
+        row = line.replace(" ", "").replace("|", "")
+        inputs, outputs = row[:ninputs], row[ninputs:]
+        cubes += 1
+        literals += sum(ch in "01" for ch in inputs) + outputs.count("1")
+    return cubes, literals
+
+
+def vm_hwm(pid):
+    """Current peak RSS (KB) of a running process, or 0 if unavailable."""
+    try:
+        with open("/proc/%d/status" % pid) as f:
+            for line in f:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1])
+    except (OSError, ValueError):
+        pass
+    return 0
+
+
+def run_once(espresso, args, pla, timeout, peakrss=None):
+    """Run espresso once; return (seconds, peak_rss_kb, output) or None."""
+    cmd, fds, rfd = [espresso] + args, (), None
+    if peakrss:
+        # peakrss reports the peak RSS of espresso alone, on a pipe
+        rfd, wfd = os.pipe()
+        cmd, fds = [peakrss, str(wfd)] + cmd, (wfd,)
+    with open(pla, "rb") as fin, tempfile.TemporaryFile() as fout:
+        start = time.monotonic()
+        proc = subprocess.Popen(cmd, stdin=fin, stdout=fout,
+                                stderr=subprocess.DEVNULL, pass_fds=fds,
+                                start_new_session=True)
+        if rfd is not None:
+            os.close(fds[0])
+        # Reap the child ourselves to get its resource usage.  ru_maxrss
+        # also counts the image the child was forked from, which is this
+        # interpreter, so without peakrss on Linux we use the high-water
+        # mark sampled from /proc instead.
+        hwm, polls = 0, 0
+        while True:
+            if HAVE_PROC and not peakrss and polls > 0:  # skip the exec
+                hwm = max(hwm, vm_hwm(proc.pid))
+            pid, status, usage = os.wait4(proc.pid, os.WNOHANG)
+            if pid != 0:
+                break
+            if time.monotonic() - start > timeout:
+                os.killpg(proc.pid, signal.SIGKILL)
+                os.wait4(proc.pid, 0)
+                proc.returncode = -signal.SIGKILL
+                if rfd is not None:
+                    os.close(rfd)
+                return None
+            time.sleep(0.001)
+            polls += 1
+        elapsed = time.monotonic() - start
+        proc.returncode = status
+        report = b""
+        if rfd is not None:
+            with os.fdopen(rfd, "rb") as fr:
+                report = fr.read()
+        if not os.WIFEXITED(status) or os.WEXITSTATUS(status) != 0:
+            raise RuntimeError("espresso failed on %s (status %d)" %
+                               (pla, status))
+        fout.seek(0)
+        out = fout.read().decode()
+
+    if peakrss:
+        rss = int(report.split()[1])
+    elif HAVE_PROC and hwm > 0:
+        rss = hwm
+    elif platform.system() == "Darwin":
+        rss = usage.ru_maxrss // 1024  # bytes on macOS
+    else:
+        # the run finished before it was sampled: an upper bound, which
+        # includes the image of this interpreter from before the exec
+        rss = usage.ru_maxrss
+    return elapsed, rss, out
+
+
+def measure(espresso, args, path, repeat, timeout, peakrss=None):
+    times, rss = [], None
+    for _ in range(repeat):
+        r = run_once(espresso, args, path, timeout, peakrss)
+        if r is None:
+            return {"status": "timeout", "timeout": timeout}
+        times.append(r[0])
+        if r[1] is not None:
+            rss = max(rss or 0, r[1])
+        out = r[2]
+    cubes, literals = cover_size(out)
+    return {
+        "status": "ok",
+        "cubes": cubes,
+        "literals": literals,
+        "time": round(statistics.median(times), 4),
+        "time_min": round(min(times), 4),
+        "runs": len(times),
+        "peak_rss_kb": rss,
+    }
+
+
+def compare(report, baseline, tolerance, min_delta):
+    regressions = 0
+    base = baseline.get("results", {})
+    print("%-28s %10s %10s %8s %8s %8s" %
+          ("pla", "base(s)", "time(s)", "speedup", "cubes", "lits"))
+    for pla, r in report["results"].items():
+        b = base.get(pla)
+        if b is None or b.get("status") != "ok":
+            continue
+        if r["status"] != "ok":
+            print("%-28s %10.3f %10s  REGRESSION (%s)" %
+                  (pla, b["time"], "-", r["status"]))
+            regressions += 1
+            continue
+        notes = []
+        if (r["time"] > b["time"] * (1 + tolerance) and
+                r["time"] - b["time"] > min_delta):
+            notes.append("slower")
+        if r["cubes"] > b["cubes"]:
+            notes.append("more cubes")
+        if r["literals"] > b["literals"]:
+            notes.append("more literals")
+        speedup = b["time"] / r["time"] if r["time"] > 0 else float("inf")
+        print("%-28s %10.3f %10.3f %8.2f %+8d %+8d%s" %
+              (pla, b["time"], r["time"], speedup, r["cubes"] - b["cubes"],
+               r["literals"] - b["literals"],
+               "  REGRESSION (" + ", ".join(notes) + ")" if notes else ""))
+        regressions += bool(notes)
+
+    both = [p for p in report["results"]
+            if report["results"][p]["status"] == "ok" and
+            base.get(p, {}).get("status") == "ok"]
+    if both:
+        total = sum(report["results"][p]["time"] for p in both)
+        btotal = sum(base[p]["time"] for p in both)
+        print("total: baseline %.3fs, now %.3fs (speedup %.2f) over %d PLAs" %
+              (btotal, total, btotal / total if total else 0, len(both)))
+    return regressions
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    ap = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    ap.add_argument("--espresso", required=True, help="espresso binary")
+    ap.add_argument("--corpus", default=os.path.join(here, "..", "examples"),
+                    help="directory holding examples/, hard_examples/, tlex/")
+    ap.add_argument("--filter", default="",
+                    help="only run PLAs whose path matches this regex")
+    ap.add_argument("--repeat", type=int, default=3,
+                    help="runs per PLA (median time is reported)")
+    ap.add_argument("--timeout", type=float, default=120,
+                    help="seconds before a single run is abandoned")
+    ap.add_argument("--output", default="bench.json", help="JSON report")
+    ap.add_argument("--baseline", help="JSON report to compare against")
+    ap.add_argument("--tolerance", type=float, default=0.10,
+                    help="allowed relative slowdown before flagging")
+    ap.add_argument("--min-delta", type=float, default=0.05,
+                    help="ignore slowdowns smaller than this many seconds")
+    ap.add_argument("--update-baseline", action="store_true",
+                    help="write the report to --baseline instead of comparing")
+    ap.add_argument("--peakrss",
+                    help="peakrss binary, to measure the peak RSS exactly")
+    ap.add_argument("--plagen", help="plagen binary, for --gen")
+    ap.add_argument("--gen", action="append", default=[], metavar="ARGS",
+                    help="also run a PLA generated by plagen ARGS")
+    ap.add_argument("--no-corpus", action="store_true",
+                    help="skip the bundled corpus (only run --gen PLAs)")
+    ap.add_argument("args", nargs="*", help="extra arguments for espresso")
+    opts = ap.parse_args()
+    if opts.gen and not opts.plagen:
+        ap.error("--gen requires --plagen")
+
+    report = {
+        "espresso": os.path.basename(opts.espresso),
+        "args": opts.args,
+        "repeat": opts.repeat,
+        "host": platform.node(),
+        "results": {},
+    }
+    with tempfile.TemporaryDirectory() as tmpdir:
+        plas = [] if opts.no_corpus else find_plas(opts.corpus, opts.filter)
+        plas += generate_plas(opts.plagen, opts.gen, tmpdir)
+        for pla, path in plas:
+            r = measure(opts.espresso, opts.args, path, opts.repeat,
+                        opts.timeout, opts.peakrss)
+            report["results"][pla] = r
+            if r["status"] == "ok":
+                rss = r["peak_rss_kb"]
+                print("%-28s %8.3fs %8s KB %6d cubes %7d literals" %
+                      (pla, r["time"], "-" if rss is None else rss,
+                       r["cubes"], r["literals"]))
+            else:
+                print("%-28s %s" % (pla, r["status"]))
+            sys.stdout.flush()
+
+    with open(opts.output, "w") as fout:
+        json.dump(report, fout, indent=1, sort_keys=True)
+        fout.write("\n")
+
+    if opts.baseline and opts.update_baseline:
+        with open(opts.baseline, "w") as fout:
+            json.dump(report, fout, indent=1, sort_keys=True)
+            fout.write("\n")
+    elif opts.baseline:
+        with open(opts.baseline) as fin:
+            baseline = json.load(fin)
+        print()
+        if compare(report, baseline, opts.tolerance, opts.min_delta):
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,322 @@
+/*
+ *  microbench.c -- timing harness for the set and cube primitives
+ *
+ *  A synthetic cover is built with a given number of binary inputs,
+ *  outputs, cubes and literal density, and the low-level kernels of
+ *  set.c, setc.c and cofactor.c are timed over it.  Each kernel is
+ *  repeated until it has run for at least the requested time, and is
+ *  reported as nanoseconds per call and cubes processed per second.
+ *
+ *  Pairwise kernels (cdist0, consensus, ...) are called once per cube of
+ *  the cover, against the next cube; list kernels (cofactor, massive_count)
+ *  process the whole cover on every call.
+ *
+ *  usage: espresso-microbench [-i inputs] [-o outputs] [-c cubes]
+ *                             [-d density] [-s seed] [-t seconds] [kernel...]
+ */
+
+#include "espresso.h"
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    long calls;    /* number of kernel invocations */
+    double cubes;  /* number of cubes processed */
+    unsigned sink; /* keeps the results alive */
+} kstat_t;
+
+typedef struct {
+    char *name;
+    void (*run)(pcover F, pcube *T, kstat_t *st);
+} kernel_t;
+
+static unsigned long long rng_state;
+
+static unsigned int rng_next() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned int)(rng_state >> 32);
+}
+
+static double rng_uniform() {
+    return rng_next() / 4294967296.0;
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* random_cover -- each input is a literal with probability "density" */
+static pcover random_cover(int ncubes, double density) {
+    pcover F;
+    pcube p;
+    int i, var, first, last;
+
+    F = new_cover(ncubes);
+    first = cube.first_part[cube.output];
+    last = cube.last_part[cube.output];
+    for (i = 0; i < ncubes; i++) {
+        p = set_clear(GETSET(F, F->count++), cube.size);
+        for (var = 0; var < cube.num_binary_vars; var++) {
+            if (rng_uniform() < density) {
+                set_insert(p, 2 * var + (rng_next() & 1));
+            } else {
+                set_insert(p, 2 * var);
+                set_insert(p, 2 * var + 1);
+            }
+        }
+        set_insert(p, first + rng_next() % (last - first + 1));
+        for (var = first; var <= last; var++) {
+            if (rng_next() & 1) {
+                set_insert(p, var);
+            }
+        }
+    }
+    return F;
+}
+
+#define NEXT(F, i) GETSET(F, ((i) + 1) % (F)->count)
+
+static void k_cdist0(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    pcube p;
+    (void)T;
+    foreachi_set(F, i, p) st->sink += cdist0(p, NEXT(F, i));
+    st->calls += F->count;
+    st->cubes += F->count;
+}
+
+static void k_cdist01(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    pcube p;
+    (void)T;
+    foreachi_set(F, i, p) st->sink += cdist01(p, NEXT(F, i));
+    st->calls += F->count;
+    st->cubes += F->count;
+}
+
+static void k_cdist(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    pcube p;
+    (void)T;
+    foreachi_set(F, i, p) st->sink += cdist(p, NEXT(F, i));
+    st->calls += F->count;
+    st->cubes += F->count;
+}
+
+static void k_consensus(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    pcube p, r = cube.temp[8];
+    (void)T;
+    foreachi_set(F, i, p) {
+        consensus(r, p, NEXT(F, i));
+        st->sink += r[1];
+    }
+    st->calls += F->count;
+    st->cubes += F->count;
+}
+
+static void k_force_lower(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    pcube p, r = cube.temp[8];
+    (void)T;
+    foreachi_set(F, i, p) {
+        (void)set_clear(r, cube.size);
+        st->sink += force_lower(r, p, NEXT(F, i))[1];
+    }
+    st->calls += F->count;
+    st->cubes += F->count;
+}
+
+static void k_ccommon(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    pcube p;
+    (void)T;
+    foreachi_set(F, i, p) st->sink += ccommon(p, NEXT(F, i), cube.emptyset);
+    st->calls += F->count;
+    st->cubes += F->count;
+}
+
+static void k_setp_implies(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    pcube p;
+    (void)T;
+    foreachi_set(F, i, p) st->sink += setp_implies(p, NEXT(F, i));
+    st->calls += F->count;
+    st->cubes += F->count;
+}
+
+static void k_set_ord(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    pcube p;
+    (void)T;
+    foreachi_set(F, i, p) st->sink += set_ord(p);
+    st->calls += F->count;
+    st->cubes += F->count;
+}
+
+/* list kernels: each call processes every cube of F */
+#define LIST_CALLS 16
+
+static void k_cofactor(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    pcube *Tc;
+    for (i = 0; i < LIST_CALLS; i++) {
+        Tc = cofactor(T, GETSET(F, i % F->count));
+        st->sink += CUBELISTSIZE(Tc);
+        free_cubelist(Tc);
+    }
+    st->calls += LIST_CALLS;
+    st->cubes += (double)LIST_CALLS * F->count;
+}
+
+static void k_scofactor(pcover F, pcube *T, kstat_t *st) {
+    int i, var;
+    pcube c = cube.temp[8], *Tc;
+    for (i = 0; i < LIST_CALLS; i++) {
+        var = i % cube.num_binary_vars;
+        (void)set_copy(c, cube.fullset);
+        set_remove(c, 2 * var + (i & 1));
+        Tc = scofactor(T, c, var);
+        st->sink += CUBELISTSIZE(Tc);
+        free_cubelist(Tc);
+    }
+    st->calls += LIST_CALLS;
+    st->cubes += (double)LIST_CALLS * F->count;
+}
+
+static void k_massive_count(pcover F, pcube *T, kstat_t *st) {
+    int i;
+    for (i = 0; i < LIST_CALLS; i++) {
+        massive_count(T);
+        st->sink += cdata.best;
+    }
+    st->calls += LIST_CALLS;
+    st->cubes += (double)LIST_CALLS * F->count;
+}
+
+static kernel_t kernels[] = {
+    {"cdist0", k_cdist0},
+    {"cdist01", k_cdist01},
+    {"cdist", k_cdist},
+    {"consensus", k_consensus},
+    {"force_lower", k_force_lower},
+    {"ccommon", k_ccommon},
+    {"setp_implies", k_setp_implies},
+    {"set_ord", k_set_ord},
+    {"cofactor", k_cofactor},
+    {"scofactor", k_scofactor},
+    {"massive_count", k_massive_count},
+    {NULL, NULL},
+};
+
+static void usage() {
+    kernel_t *k;
+    fprintf(stderr,
+            "usage: espresso-microbench [-i inputs] [-o outputs] [-c cubes]\n"
+            "                           [-d density] [-s seed] [-t seconds]"
+            " [kernel...]\n"
+            "kernels:");
+    for (k = kernels; k->name != NULL; k++) {
+        fprintf(stderr, " %s", k->name);
+    }
+    fprintf(stderr, "\n");
+    exit(2);
+}
+
+static bool selected(char *name, int argc, char **argv) {
+    int i;
+    if (argc == 0) {
+        return TRUE;
+    }
+    for (i = 0; i < argc; i++) {
+        if (equal(name, argv[i])) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+int main(int argc, char **argv) {
+    int ninputs = 32, noutputs = 8, ncubes = 1000, opt;
+    double density = 0.5, min_time = 0.2, start, elapsed;
+    unsigned long long seed = 1;
+    kernel_t *k;
+    kstat_t st;
+    pcover F;
+    pcube *T;
+    long passes;
+
+    while ((opt = getopt(argc, argv, "i:o:c:d:s:t:")) != -1) {
+        switch (opt) {
+            case 'i':
+                ninputs = atoi(optarg);
+                break;
+            case 'o':
+                noutputs = atoi(optarg);
+                break;
+            case 'c':
+                ncubes = atoi(optarg);
+                break;
+            case 'd':
+                density = atof(optarg);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 't':
+                min_time = atof(optarg);
+                break;
+            default:
+                usage();
+        }
+    }
+    if (ninputs <= 0 || noutputs <= 0 || ncubes <= 0) {
+        usage();
+    }
+
+    cube.num_binary_vars = ninputs;
+    cube.num_vars = ninputs + 1;
+    cube.part_size = ALLOC(int, cube.num_vars);
+    cube.part_size[cube.num_vars - 1] = noutputs;
+    cube_setup();
+
+    rng_state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    F = random_cover(ncubes, density);
+    T = cube1list(F);
+
+    printf("# %d inputs, %d outputs, %d cubes, density %.2f, seed %llu\n",
+           ninputs, noutputs, ncubes, density, seed);
+    printf("%-14s %12s %12s %12s\n", "kernel", "calls", "ns/call",
+           "Mcubes/s");
+    for (k = kernels; k->name != NULL; k++) {
+        if (!selected(k->name, argc - optind, argv + optind)) {
+            continue;
+        }
+        st.calls = 0;
+        st.cubes = 0;
+        st.sink = 0;
+        start = now();
+        for (passes = 1; (elapsed = now() - start) < min_time; passes *= 2) {
+            long i;
+            for (i = 0; i < passes; i++) {
+                k->run(F, T, &st);
+            }
+        }
+        printf("%-14s %12ld %12.2f %12.2f\n", k->name, st.calls,
+               elapsed * 1e9 / st.calls, st.cubes / elapsed * 1e-6);
+        if (st.sink == 0xdeadbeef) {
+            printf("\n"); /* never true; defeats dead code elimination */
+        }
+    }
+
+    free_cubelist(T);
+    free_cover(F);
+    FREE(cube.part_size);
+    setdown_cube();
+    sf_cleanup();
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ *  peakrss.c -- run a command and report its peak resident set size
+ *
+ *  bench.py measures espresso through this program.  The peak RSS that
+ *  wait4() reports for a child includes the image it was forked from, and
+ *  for a child of the Python interpreter that is the interpreter itself,
+ *  larger than espresso on most of the corpus.  Forked from this small
+ *  program instead, the command's peak RSS is its own (plus the few
+ *  hundred KB of peakrss before the exec).
+ *
+ *  The command's stdin, stdout and stderr are left alone; the peak RSS
+ *  (in KB) is written to the file descriptor fd as "peak_rss_kb N".  The
+ *  exit status is the command's, or 128 + the signal which killed it.
+ *
+ *  usage: peakrss fd command [args ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+    struct rusage usage;
+    long kb;
+    int fd, status;
+    pid_t pid;
+    char line[64];
+
+    if (argc < 3) {
+        fprintf(stderr, "usage: peakrss fd command [args ...]\n");
+        return 2;
+    }
+    fd = atoi(argv[1]);
+
+    pid = fork();
+    if (pid < 0) {
+        perror("peakrss: fork");
+        return 2;
+    }
+    if (pid == 0) {
+        (void)close(fd);
+        execvp(argv[2], argv + 2);
+        perror("peakrss: exec");
+        _exit(127);
+    }
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        perror("peakrss: wait4");
+        return 2;
+    }
+
+#ifdef __APPLE__
+    kb = (long)(usage.ru_maxrss / 1024); /* bytes on macOS */
+#else
+    kb = (long)usage.ru_maxrss;
+#endif
+    (void)snprintf(line, sizeof(line), "peak_rss_kb %ld\n", kb);
+    if (write(fd, line, strlen(line)) < 0) {
+        perror("peakrss: write");
+    }
+
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return WEXITSTATUS(status);
+}
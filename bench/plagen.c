@@ -0,0 +1,247 @@
+/*
+ *  plagen.c -- generate synthetic PLAs for scaling studies
+ *
+ *  The output is a PLA in espresso format, written to stdout.  All
+ *  randomness comes from a seeded xorshift generator, so the same
+ *  arguments always produce the same file.
+ *
+ *  Structures:
+ *
+ *	random	-- "cubes" cubes; each input is a literal with probability
+ *		   "density", each output is asserted with probability 1/2
+ *		   (at least one output per cube)
+ *
+ *	add	-- the inputs are split into two operands a and b; output k
+ *		   is bit k of a + b
+ *
+ *	mul	-- as add, but output k is bit k of a * b
+ *
+ *	rom	-- a full truth table; each output bit is 1 with probability
+ *		   "density"
+ *
+ *  Minterms with no output asserted are not listed.  For add and mul, all
+ *  minterms are listed when there are at most "cubes" of them; otherwise
+ *  "cubes" minterms are sampled (with replacement), and the unsampled
+ *  minterms belong to the off-set.
+ *
+ *  A fraction "dcfrac" of the cubes is emitted as don't-care cubes (their
+ *  asserted outputs are written as '-') and the PLA is then of type fd.
+ *
+ *  usage: plagen [-m structure] [-i inputs] [-o outputs] [-c cubes]
+ *                [-d density] [-x dcfrac] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_ROM_INPUTS 24
+
+static unsigned long long rng_state;
+
+static unsigned int rng_next() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned int)(rng_state >> 32);
+}
+
+static double rng_uniform() {
+    return rng_next() / 4294967296.0;
+}
+
+static int ninputs = 16, noutputs = 4;
+static long ncubes = 1000;
+static double density = 0.5, dcfrac = 0.0;
+static char *line; /* inputs, space, outputs, newline, NUL */
+
+/* put_outputs -- write the output part of line, then print the line */
+static void put_outputs(char *out) {
+    int k, is_dc, any = 0;
+    char *p = line + ninputs + 1;
+    for (k = 0; k < noutputs; k++) {
+        any |= out[k] == '1';
+    }
+    if (!any) {
+        return; /* a minterm of the off-set; no need to list it */
+    }
+    is_dc = dcfrac > 0 && rng_uniform() < dcfrac;
+    for (k = 0; k < noutputs; k++) {
+        p[k] = out[k] == '1' && is_dc ? '-' : out[k];
+    }
+    fputs(line, stdout);
+}
+
+static void gen_random() {
+    long i;
+    int var, k, any;
+    char *out = malloc(noutputs);
+
+    printf(".p %ld\n", ncubes);
+    for (i = 0; i < ncubes; i++) {
+        for (var = 0; var < ninputs; var++) {
+            if (rng_uniform() < density) {
+                line[var] = (rng_next() & 1) ? '1' : '0';
+            } else {
+                line[var] = '-';
+            }
+        }
+        any = 0;
+        for (k = 0; k < noutputs; k++) {
+            out[k] = (rng_next() & 1) ? '1' : '0';
+            any |= out[k] == '1';
+        }
+        if (!any) {
+            out[rng_next() % noutputs] = '1';
+        }
+        put_outputs(out);
+    }
+    free(out);
+}
+
+/* arith_eval -- bits of a (+|*) b into r, all little-endian 0/1 arrays */
+static void arith_eval(int mul, char *a, char *b, int n, char *r, int rn) {
+    int i, j, carry;
+
+    memset(r, 0, rn);
+    if (!mul) {
+        for (carry = 0, i = 0; i < rn; i++) {
+            carry += (i < n ? a[i] + b[i] : 0);
+            r[i] = carry & 1;
+            carry >>= 1;
+        }
+        return;
+    }
+    for (i = 0; i < n; i++) {
+        if (!a[i]) {
+            continue;
+        }
+        for (carry = 0, j = 0; i + j < rn; j++) {
+            carry += r[i + j] + (j < n ? b[j] : 0);
+            r[i + j] = carry & 1;
+            carry >>= 1;
+        }
+    }
+}
+
+static void gen_arith(int mul) {
+    int n = ninputs / 2, rn = mul ? 2 * n : n + 1, var, k;
+    long i, count;
+    int enumerate = ninputs < 62 && (1LL << ninputs) <= ncubes;
+    char *bits = malloc(ninputs), *r = malloc(rn), *out = malloc(noutputs);
+
+    count = enumerate ? 1L << ninputs : ncubes;
+    for (i = 0; i < count; i++) {
+        for (var = 0; var < ninputs; var++) {
+            bits[var] = enumerate ? (i >> var) & 1 : rng_next() & 1;
+        }
+        /* an odd input is left out of both operands */
+        arith_eval(mul, bits, bits + n, n, r, rn);
+        for (var = 0; var < ninputs; var++) {
+            /* most significant input first, as in the usual PLA layout */
+            line[ninputs - 1 - var] = bits[var] ? '1' : '0';
+        }
+        for (k = 0; k < noutputs; k++) {
+            out[k] = (k < rn && r[k]) ? '1' : '0';
+        }
+        put_outputs(out);
+    }
+    free(bits);
+    free(r);
+    free(out);
+}
+
+static void gen_rom() {
+    long i, count = 1L << ninputs;
+    int var, k;
+    char *out = malloc(noutputs);
+
+    for (i = 0; i < count; i++) {
+        for (var = 0; var < ninputs; var++) {
+            line[ninputs - 1 - var] = (i >> var) & 1 ? '1' : '0';
+        }
+        for (k = 0; k < noutputs; k++) {
+            out[k] = rng_uniform() < density ? '1' : '0';
+        }
+        put_outputs(out);
+    }
+    free(out);
+}
+
+static void usage() {
+    fprintf(stderr,
+            "usage: plagen [-m random|add|mul|rom] [-i inputs] [-o outputs]\n"
+            "              [-c cubes] [-d density] [-x dcfrac] [-s seed]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    char *structure = "random";
+    unsigned long long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:i:o:c:d:x:s:")) != -1) {
+        switch (opt) {
+            case 'm':
+                structure = optarg;
+                break;
+            case 'i':
+                ninputs = atoi(optarg);
+                break;
+            case 'o':
+                noutputs = atoi(optarg);
+                break;
+            case 'c':
+                ncubes = atol(optarg);
+                break;
+            case 'd':
+                density = atof(optarg);
+                break;
+            case 'x':
+                dcfrac = atof(optarg);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            default:
+                usage();
+        }
+    }
+    if (optind != argc || ninputs <= 0 || noutputs <= 0 || ncubes <= 0) {
+        usage();
+    }
+    if (strcmp(structure, "random") != 0 && strcmp(structure, "add") != 0 &&
+        strcmp(structure, "mul") != 0 && strcmp(structure, "rom") != 0) {
+        usage();
+    }
+    if (strcmp(structure, "rom") == 0 && ninputs > MAX_ROM_INPUTS) {
+        fprintf(stderr, "plagen: rom is limited to %d inputs\n",
+                MAX_ROM_INPUTS);
+        exit(1);
+    }
+
+    rng_state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    line = malloc(ninputs + noutputs + 3);
+    line[ninputs] = ' ';
+    line[ninputs + 1 + noutputs] = '\n';
+    line[ninputs + 2 + noutputs] = '\0';
+
+    printf("# plagen -m %s -i %d -o %d -c %ld -d %g -x %g -s %llu\n",
+           structure, ninputs, noutputs, ncubes, density, dcfrac, seed);
+    printf(".i %d\n.o %d\n", ninputs, noutputs);
+    if (dcfrac > 0) {
+        printf(".type fd\n");
+    }
+    if (strcmp(structure, "random") == 0) {
+        gen_random();
+    } else if (strcmp(structure, "rom") == 0) {
+        gen_rom();
+    } else {
+        gen_arith(strcmp(structure, "mul") == 0);
+    }
+    printf(".e\n");
+
+    free(line);
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ *  replay.c -- run subproblems captured by "espresso -c dir"
+ *
+ *  Each file is solved --repeat times with the same engine espresso used
+ *  when it was captured (see espresso/capture.c), and the size of the
+ *  problem, its answer and the time per solve are reported:
+ *
+ *	taut	-- tautology() of the cube list; the answer is 0 or 1
+ *	compl	-- complement() of the cube list; the answer is the number
+ *		   of cubes in the complement
+ *	irred, mincov
+ *		-- sm_minimum_cover() of the matrix; the answer is the number
+ *		   of columns in the cover
+ *
+ *  usage: espresso-replay [-r repeat] file...
+ */
+
+#include "espresso.h"
+#include <time.h>
+#include <unistd.h>
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void replay_cubelist(FILE *fp, char *kind, int repeat, int *size,
+                            int *answer, double *elapsed) {
+    pPLA PLA = new_PLA();
+    pcover R;
+    double start;
+    int i;
+
+    parse_pla(fp, PLA);
+    if (PLA->F == NULL) {
+        fatal("no cubes in capture file");
+    }
+    *size = PLA->F->count;
+    start = now();
+    for (i = 0; i < repeat; i++) {
+        if (equal(kind, "taut")) {
+            *answer = tautology(cube1list(PLA->F));
+        } else {
+            R = complement(cube1list(PLA->F));
+            *answer = R->count;
+            free_cover(R);
+        }
+    }
+    *elapsed = now() - start;
+
+    free_PLA(PLA);
+    FREE(cube.part_size);
+    setdown_cube();
+}
+
+static void replay_matrix(FILE *fp, int repeat, int *size, int *answer,
+                          double *elapsed) {
+    char line[BUFSIZ], *s, *end;
+    sm_matrix *A = sm_alloc();
+    sm_row *cover;
+    int *weight = NIL(int), heuristic = 1, row = 0, col, w, i, len;
+    double start;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (line[0] == '#') {
+            continue;
+        } else if (strncmp(line, ".e", 2) == 0) {
+            break;
+        } else if (strncmp(line, ".rows", 5) == 0) {
+            continue;
+        } else if (strncmp(line, ".heuristic", 10) == 0) {
+            heuristic = atoi(line + 10);
+            continue;
+        } else if (strncmp(line, ".weight", 7) == 0) {
+            s = line + 7;
+            while (sscanf(s, " %d:%d%n", &col, &w, &len) == 2) {
+                weight = REALLOC(int, weight, col + 1);
+                weight[col] = w;
+                s += len;
+            }
+            continue;
+        }
+        /* a row: its column numbers (lines may exceed the buffer) */
+        s = line;
+        do {
+            while ((col = (int)strtol(s, &end, 10)), end != s) {
+                (void)sm_insert(A, row, col);
+                s = end;
+            }
+        } while (strchr(line, '\n') == NULL &&
+                 (s = fgets(line, sizeof(line), fp)) != NULL);
+        row++;
+    }
+    *size = A->nrows;
+
+    start = now();
+    for (i = 0; i < repeat; i++) {
+        cover = sm_minimum_cover(A, weight, heuristic);
+        *answer = cover->length;
+        sm_row_free(cover);
+    }
+    *elapsed = now() - start;
+
+    sm_free(A);
+    FREE(weight);
+}
+
+static void usage() {
+    fprintf(stderr, "usage: espresso-replay [-r repeat] file...\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    char line[BUFSIZ], kind[64];
+    int repeat = 1, opt, size, answer;
+    double elapsed;
+    FILE *fp;
+
+    while ((opt = getopt(argc, argv, "r:")) != -1) {
+        switch (opt) {
+            case 'r':
+                repeat = atoi(optarg);
+                break;
+            default:
+                usage();
+        }
+    }
+    if (optind == argc || repeat <= 0) {
+        usage();
+    }
+
+    printf("%-32s %-7s %8s %8s %12s\n", "file", "kind", "size", "answer",
+           "ms/solve");
+    for (; optind < argc; optind++) {
+        if ((fp = fopen(argv[optind], "r")) == NULL) {
+            perror(argv[optind]);
+            exit(1);
+        }
+        if (fgets(line, sizeof(line), fp) == NULL ||
+            sscanf(line, "# espresso capture: %63s", kind) != 1) {
+            fprintf(stderr, "%s: not a capture file\n", argv[optind]);
+            exit(1);
+        }
+        if (equal(kind, "taut") || equal(kind, "compl")) {
+            replay_cubelist(fp, kind, repeat, &size, &answer, &elapsed);
+        } else {
+            replay_matrix(fp, repeat, &size, &answer, &elapsed);
+        }
+        (void)fclose(fp);
+        printf("%-32s %-7s %8d %8d %12.3f\n", argv[optind], kind, size, answer,
+               elapsed * 1e3 / repeat);
+    }
+
+    sf_cleanup();
+    sm_cleanup();
+    return 0;
+}
@@ -0,0 +1,321 @@
+/*
+    module: blocking.c
+    purpose: the blocking matrix of expand(), kept by columns
+
+    expand1() asks the same few questions about the OFF-set (the blocking
+    matrix BB) over and over: which active cubes of BB are distance 0 or 1
+    from a cube r, and which parts do the active cubes contain.  Asked
+    cube by cube, each question costs a pass over every active cube.
+
+    While expand() runs, blocking_setup() also keeps BB by columns: for
+    each part, a bit vector over the cubes of BB which contain it, and one
+    more bit vector of the active cubes.  The distance of every cube from
+    r is then found 64 cubes at a time, looking only at the variables
+    which r does not contain entirely, and only at the words of the active
+    vector which are not yet 0.
+
+    The routines in expand.c call the ones here when BB is the cover set
+    up by blocking_setup().  active_count is kept up to date, but the
+    ACTIVE flags of the cubes only once the cube by cube loops take over
+    again: when few cubes are left active, or they are spread too thinly
+    over the words, and before mincov() unravels the rows of BB.  From
+    then on until the next setup_BB_CC() the rows are used.
+
+    The blocking matrix belongs to the thread; the threads of the parallel
+    expand each keep one for their own copy of the OFF-set, and switch to
+    it with blocking_swap().
+*/
+
+#include "espresso.h"
+
+/* fewer active cubes than this are left to the cube by cube loops */
+#define BLOCKING_MIN 256
+/* the columns are used while 1 in this many cubes is active */
+#define BLOCKING_DENSITY 16
+
+typedef unsigned long long word_t;
+#define WBITS 64
+
+typedef struct {
+    pcover BB;   /* the blocking matrix */
+    int nwords;  /* words in each bit vector */
+    word_t *col; /* col + j * nwords -- the cubes of BB with part j */
+    word_t *active;
+    word_t *one, *two; /* cubes at distance >= 1 (>= 2) from r */
+    int *live;         /* the words of active which are not 0 */
+    int nlive;
+    bool rows; /* the ACTIVE flags of BB are in use instead */
+    int *parts; /* scratch list of parts */
+} blocking_t;
+
+static _Thread_local blocking_t *blocking;
+
+/* blocking_setup -- start keeping BB by columns (if it is large enough) */
+void blocking_setup(pcover BB) {
+    blocking_t *b;
+    pcube p;
+    word_t bit;
+    int i, j, n;
+
+    if (BB->count < BLOCKING_MIN) {
+        blocking = NIL(blocking_t);
+        return;
+    }
+    b = ALLOC(blocking_t, 1);
+    b->BB = BB;
+    b->nwords = n = (BB->count + WBITS - 1) / WBITS;
+    b->col = ALLOC(word_t, cube.size * n);
+    b->active = ALLOC(word_t, n);
+    b->one = ALLOC(word_t, n);
+    b->two = ALLOC(word_t, n);
+    b->live = ALLOC(int, n);
+    b->parts = ALLOC(int, cube.size);
+    b->rows = TRUE; /* until blocking_reset() */
+    for (i = 0; i < cube.size * n; i++)
+        b->col[i] = 0;
+    foreachi_set(BB, i, p) {
+        bit = (word_t)1 << (i % WBITS);
+        for (j = 0; j < cube.size; j++)
+            if (is_in_set(p, j))
+                b->col[j * n + i / WBITS] |= bit;
+    }
+    blocking = b;
+}
+
+/* blocking_free -- stop keeping BB by columns */
+void blocking_free() {
+    blocking_t *b = blocking;
+
+    if (b != NIL(blocking_t)) {
+        FREE(b->col);
+        FREE(b->active);
+        FREE(b->one);
+        FREE(b->two);
+        FREE(b->live);
+        FREE(b->parts);
+        FREE(b);
+        blocking = NIL(blocking_t);
+    }
+}
+
+/* sync_rows -- hand BB back to the cube by cube loops */
+static void sync_rows(blocking_t *b) {
+    pcube p;
+    int i;
+
+    foreachi_set(b->BB, i, p) {
+        if (b->active[i / WBITS] & (word_t)1 << (i % WBITS))
+            SET(p, ACTIVE);
+        else
+            RESET(p, ACTIVE);
+    }
+    b->rows = TRUE;
+}
+
+/* blocking_swap -- make b the blocking matrix of this thread */
+void *blocking_swap(void *b) {
+    blocking_t *old = blocking;
+
+    blocking = b;
+    return old; /* the previous one */
+}
+
+/* blocking_of -- TRUE if BB is kept by columns, and should be used */
+bool blocking_of(pcover BB) {
+    blocking_t *b = blocking;
+
+    if (b == NIL(blocking_t) || b->BB != BB || b->rows)
+        return FALSE;
+    if (BB->active_count < BLOCKING_MIN ||
+        BB->active_count * BLOCKING_DENSITY < b->nlive * WBITS) {
+        sync_rows(b);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* blocking_sync -- bring the ACTIVE flags of the cubes of BB up to date */
+void blocking_sync(pcover BB) {
+    blocking_t *b = blocking;
+
+    if (b != NIL(blocking_t) && b->BB == BB && !b->rows)
+        sync_rows(b);
+}
+
+/* update_live -- drop the words of active which have become 0 */
+static void update_live(blocking_t *b) {
+    int k, n = 0;
+
+    for (k = 0; k < b->nlive; k++)
+        if (b->active[b->live[k]] != 0)
+            b->live[n++] = b->live[k];
+    b->nlive = n;
+}
+
+/* deactivate -- make the cubes of BB in bits of word k inactive */
+static void deactivate(blocking_t *b, int k, word_t bits) {
+    unsigned int half;
+
+    b->active[k] &= ~bits;
+    half = (unsigned int)bits;
+    b->BB->active_count -= count_ones(half);
+    half = (unsigned int)(bits >> 32);
+    b->BB->active_count -= count_ones(half);
+}
+
+/*
+ *  blocking_reset -- make every cube of BB active (see setup_BB_CC);
+ *  returns FALSE if BB is not kept by columns, and its rows must be set
+ */
+bool blocking_reset(pcover BB) {
+    blocking_t *b = blocking;
+    int k, rest = BB->count % WBITS;
+
+    if (b == NIL(blocking_t) || b->BB != BB)
+        return FALSE;
+
+    for (k = 0; k < b->nwords; k++) {
+        b->active[k] = ~(word_t)0;
+        b->live[k] = k;
+    }
+    if (rest != 0)
+        b->active[b->nwords - 1] = ((word_t)1 << rest) - 1;
+    b->nlive = b->nwords;
+    b->rows = FALSE;
+    return TRUE;
+}
+
+/*
+ *  var_parts -- list the parts of var in r; returns how many there are,
+ *  or -1 if r contains the whole variable
+ */
+static int var_parts(blocking_t *b, pcube r, int var) {
+    int j, n = 0;
+
+    for (j = cube.first_part[var]; j <= cube.last_part[var]; j++)
+        if (is_in_set(r, j))
+            b->parts[n++] = j;
+    return n == cube.part_size[var] ? -1 : n;
+}
+
+/* miss -- the active cubes of word k which have no part of var in r */
+static word_t miss(blocking_t *b, int n, int k) {
+    word_t hit = 0;
+    int j;
+
+    for (j = 0; j < n; j++)
+        hit |= b->col[b->parts[j] * b->nwords + k];
+    return b->active[k] & ~hit;
+}
+
+/* distance -- set one and two to the active cubes at distance >= 1, 2 */
+static void distance(blocking_t *b, pcube r) {
+    int var, n, k, w;
+    word_t x;
+
+    for (k = 0; k < b->nlive; k++) {
+        w = b->live[k];
+        b->one[w] = b->two[w] = 0;
+    }
+    for (var = 0; var < cube.num_vars; var++) {
+        if ((n = var_parts(b, r, var)) < 0)
+            continue;
+        for (k = 0; k < b->nlive; k++) {
+            w = b->live[k];
+            x = miss(b, n, w);
+            b->two[w] |= b->one[w] & x;
+            b->one[w] |= x;
+        }
+    }
+}
+
+/*
+ *  lower_parts -- add to xlower the parts of the conflicting variable of
+ *  each active cube at distance 1 from r (as force_lower does); returns
+ *  FALSE (and leaves xlower alone) if some active cube is distance 0
+ */
+static bool lower_parts(blocking_t *b, pcube r, pcube xlower) {
+    int var, n, j, k, w;
+    bool any = FALSE;
+    word_t x;
+
+    distance(b, r);
+    for (k = 0; k < b->nlive; k++) {
+        w = b->live[k];
+        if (b->active[w] & ~b->one[w])
+            return FALSE;
+        b->one[w] &= ~b->two[w]; /* now the cubes at distance 1 */
+        any |= b->one[w] != 0;
+    }
+    if (!any)
+        return TRUE;
+    for (var = 0; var < cube.num_vars; var++) {
+        if ((n = var_parts(b, r, var)) < 0)
+            continue;
+        for (k = 0; k < b->nlive; k++) {
+            w = b->live[k];
+            if ((x = miss(b, n, w) & b->one[w]) == 0)
+                continue;
+            for (j = cube.first_part[var]; j <= cube.last_part[var]; j++)
+                if (b->col[j * b->nwords + w] & x)
+                    set_insert(xlower, j);
+        }
+    }
+    return TRUE;
+}
+
+/* blocking_essen_parts -- essen_parts() for the cubes of BB */
+void blocking_essen_parts(pcube RAISE, pcube xlower) {
+    blocking_t *b = blocking;
+    int k, w;
+
+    if (!lower_parts(b, RAISE, xlower))
+        fatal("ON-set and OFF-set are not orthogonal");
+    for (k = 0; k < b->nlive; k++) {
+        w = b->live[k];
+        if (b->one[w] != 0)
+            deactivate(b, w, b->one[w]);
+    }
+    update_live(b);
+}
+
+/* blocking_feasibly_covered -- feasibly_covered() for the cubes of BB */
+bool blocking_feasibly_covered(pcube r, pcube new_lower) {
+    return lower_parts(blocking, r, new_lower);
+}
+
+/* blocking_elim_lowering -- make the cubes of BB disjoint from r inactive */
+void blocking_elim_lowering(pcube r) {
+    blocking_t *b = blocking;
+    int var, n, k, w;
+    word_t x;
+
+    for (var = 0; var < cube.num_vars; var++) {
+        if ((n = var_parts(b, r, var)) < 0)
+            continue;
+        for (k = 0; k < b->nlive; k++) {
+            w = b->live[k];
+            if ((x = miss(b, n, w)) != 0)
+                deactivate(b, w, x);
+        }
+        update_live(b);
+    }
+}
+
+/* blocking_union -- the parts of mask which some active cube of BB has */
+void blocking_union(pcube mask, pcube result) {
+    blocking_t *b = blocking;
+    word_t *c;
+    int j, k;
+
+    (void)set_copy(result, cube.emptyset);
+    for (j = 0; j < cube.size; j++)
+        if (is_in_set(mask, j)) {
+            c = b->col + j * b->nwords;
+            for (k = 0; k < b->nlive; k++)
+                if (c[b->live[k]] & b->active[b->live[k]]) {
+                    set_insert(result, j);
+                    break;
+                }
+        }
+}
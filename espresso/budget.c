@@ -0,0 +1,95 @@
+/*
+    module: budget.c
+    purpose: run-time budget and cover snapshots for espresso()
+
+    budget_start() arms a wall-clock timer of time_limit seconds (if
+    time_limit > 0), and makes SIGUSR1 request a snapshot of the cover.
+    Both only set flags; they are acted on by budget_check(), which
+    espresso() calls at its safe points -- where the current cover is a
+    valid cover of the function.  When the budget has run out, espresso()
+    returns the cover it has at that point and sets budget_truncated (for
+    the calling thread).
+
+    The timer also sets mincov_interrupt, which makes an exact
+    sm_minimum_cover() (heuristic == 0) stop branching and return the best
+    cover it has found, for the library callers which ask for one.
+    espresso's own covering calls (irredundant and expand) are heuristic:
+    they never branch, so the flag does not bound them, and they always
+    run to the end.
+*/
+
+#include "espresso.h"
+#include <sys/time.h>
+
+/* the flags are set by signal handlers, and read by every thread */
+_Atomic int budget_expired;
+static _Atomic int snapshot_requested;
+
+_Thread_local bool budget_truncated;
+
+static void budget_alarm(int sig) {
+    (void)sig;
+    budget_expired = 1;
+    mincov_interrupt = 1;
+}
+
+static void budget_usr1(int sig) {
+    (void)sig;
+    snapshot_requested = 1;
+}
+
+/* budget_start -- start the clock for time_limit, and catch SIGUSR1 */
+void budget_start() {
+    struct sigaction sa;
+    struct itimerval it;
+
+    budget_expired = 0;
+    budget_truncated = FALSE;
+    mincov_interrupt = 0;
+
+    sa.sa_flags = SA_RESTART;
+    (void)sigemptyset(&sa.sa_mask);
+    sa.sa_handler = budget_usr1;
+    (void)sigaction(SIGUSR1, &sa, NULL);
+
+    if (time_limit > 0) {
+        sa.sa_handler = budget_alarm;
+        (void)sigaction(SIGALRM, &sa, NULL);
+        it.it_interval.tv_sec = it.it_interval.tv_usec = 0;
+        it.it_value.tv_sec = (long)time_limit;
+        it.it_value.tv_usec = (long)((time_limit - (long)time_limit) * 1e6);
+        if (it.it_value.tv_sec == 0 && it.it_value.tv_usec == 0) {
+            it.it_value.tv_usec = 1;
+        }
+        (void)setitimer(ITIMER_REAL, &it, NULL);
+    }
+}
+
+/*
+ *  budget_check -- called at a safe point with the current cover F and
+ *  the essential primes E (or NULL); writes a snapshot of F u E if one
+ *  was requested, and returns TRUE if the time budget has run out.
+ */
+bool budget_check(pcover F, pcover E) {
+    pcube last, p;
+
+    if (snapshot_requested) {
+        snapshot_requested = 0;
+        fprintf(stderr, "# espresso snapshot: %d cubes\n",
+                F->count + (E != NULL ? E->count : 0));
+        fprintf(stderr, ".i %d\n", cube.num_binary_vars);
+        fprintf(stderr, ".o %d\n", cube.part_size[cube.output]);
+        fprintf(stderr, ".type f\n");
+        foreach_set(F, last, p) {
+            print_cube(stderr, p, "01");
+        }
+        if (E != NULL) {
+            foreach_set(E, last, p) {
+                print_cube(stderr, p, "01");
+            }
+        }
+        fprintf(stderr, ".e\n");
+        (void)fflush(stderr);
+    }
+    return budget_expired != 0;
+}
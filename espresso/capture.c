@@ -0,0 +1,99 @@
+/*
+    module: capture.c
+    purpose: dump subproblems to files, for replay with espresso-replay
+
+    When capture_dir is set, the large subproblems met during minimization
+    are written to separate files in that directory, so that the engine
+    that solves them can be benchmarked on its own:
+
+	taut-N.pla	-- a tautology question from cube_is_covered (the cube
+			   list after cofactoring against the tested cube)
+	compl-N.pla	-- a cube list passed to complement (top-level calls)
+	irred-N.mat	-- the covering table of mark_irredundant
+	mincov-N.mat	-- the covering table of do_sm_minimum_cover
+
+    Only subproblems of at least capture_min_size cubes (or rows) are
+    written, and at most capture_max_files files in total.
+
+    Cube lists are written as a PLA: the cofactor cube T[0] is merged into
+    each cube.  Matrices are written as one line per row, listing the
+    columns of the row.
+*/
+
+#include "espresso.h"
+#include <pthread.h>
+
+static int capture_count;
+static pthread_mutex_t capture_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static FILE *capture_open(char *kind, char *ext) {
+    char *path;
+    FILE *fp;
+
+    (void)pthread_mutex_lock(&capture_lock);
+    if (capture_count >= capture_max_files) {
+        (void)pthread_mutex_unlock(&capture_lock);
+        return NULL;
+    }
+    path = ALLOC(char, strlen(capture_dir) + strlen(kind) + 20);
+    (void)sprintf(path, "%s/%s-%d.%s", capture_dir, kind, capture_count, ext);
+    if ((fp = fopen(path, "w")) == NULL) {
+        fprintf(stderr, "espresso: cannot write capture file %s\n", path);
+        capture_max_files = 0; /* do not try again */
+    } else {
+        capture_count++;
+        fprintf(fp, "# espresso capture: %s\n", kind);
+    }
+    (void)pthread_mutex_unlock(&capture_lock);
+    FREE(path);
+    return fp;
+}
+
+/* capture_cubelist -- write the cube list T, if large enough */
+void capture_cubelist(char *kind, pcube *T) {
+    pcube *T1, p, temp = cube.temp[9];
+    FILE *fp;
+
+    if (CUBELISTSIZE(T) < capture_min_size ||
+        (fp = capture_open(kind, "pla")) == NULL) {
+        return;
+    }
+    fprintf(fp, ".i %d\n", cube.num_binary_vars);
+    fprintf(fp, ".o %d\n", cube.part_size[cube.output]);
+    fprintf(fp, ".p %d\n", (int)CUBELISTSIZE(T));
+    for (T1 = T + 2; (p = *T1++) != NULL;) {
+        print_cube(fp, set_or(temp, p, T[0]), "01");
+    }
+    fprintf(fp, ".e\n");
+    (void)fclose(fp);
+}
+
+/* capture_matrix -- write the covering problem A, if large enough */
+void capture_matrix(char *kind, sm_matrix *A, int *weight, int heuristic) {
+    sm_row *prow;
+    sm_col *pcol;
+    sm_element *p;
+    FILE *fp;
+
+    if (A->nrows < capture_min_size ||
+        (fp = capture_open(kind, "mat")) == NULL) {
+        return;
+    }
+    fprintf(fp, ".rows %d\n", A->nrows);
+    fprintf(fp, ".heuristic %d\n", heuristic);
+    if (weight != NIL(int)) {
+        fprintf(fp, ".weight");
+        sm_foreach_col(A, pcol) {
+            fprintf(fp, " %d:%d", pcol->col_num, weight[pcol->col_num]);
+        }
+        fprintf(fp, "\n");
+    }
+    sm_foreach_row(A, prow) {
+        sm_foreach_row_element(prow, p) {
+            fprintf(fp, p == prow->first_col ? "%d" : " %d", p->col_num);
+        }
+        fprintf(fp, "\n");
+    }
+    fprintf(fp, ".e\n");
+    (void)fclose(fp);
+}
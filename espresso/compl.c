@@ -20,6 +20,9 @@
 #define USE_COMPL_LIFT       0
 #define USE_COMPL_LIFT_ONSET 1
 
+/* recursion depth, for capture_cubelist */
+static _Thread_local int compl_depth;
+
 /* compl_cube -- return the complement of a single cube (De Morgan's law) */
 static pcover compl_cube(pcube p) {
     pcube diff = cube.temp[7], pdest, mask, full = cube.fullset;
@@ -281,6 +284,11 @@ pcover complement(pcube *T /* T will be disposed of */
     pcover Tbar, Tl, Tr;
     int lifting;
 
+    if (capture_dir != NULL && compl_depth == 0) {
+        capture_cubelist("compl", T);
+    }
+    compl_depth++;
+
     if (compl_special_cases(T, &Tbar) == MAYBE) {
         /* Allocate space for the partition cubes */
         cl = new_cube();
@@ -303,5 +311,111 @@ pcover complement(pcube *T /* T will be disposed of */
         free_cubelist(T);
     }
 
+    compl_depth--;
     return Tbar;
 }
+
+typedef struct {
+    pcover F, D; /* the function (read only) */
+    pcover *R;   /* the complement for each output */
+} compl_output_t;
+
+/* compl_output -- complement the cofactor of F u D against output j */
+static void compl_output(int j, void *data) {
+    compl_output_t *co = data;
+    int part = cube.first_part[cube.output] + j;
+    pcube last, p, c, *T1;
+    pcover T, Rj;
+
+    /* take copies: complement() changes the flags of the cubes it is given */
+    T = new_cover(10);
+    foreach_set(co->F, last, p) {
+        if (is_in_set(p, part)) {
+            T = sf_addset(T, p);
+        }
+    }
+    foreach_set(co->D, last, p) {
+        if (is_in_set(p, part)) {
+            T = sf_addset(T, p);
+        }
+    }
+
+    c = set_diff(new_cube(), cube.fullset, cube.var_mask[cube.output]);
+    set_insert(c, part);
+    T1 = cube1list(T);
+    Rj = complement(cofactor(T1, c));
+    foreach_set(Rj, last, p) {
+        (void)set_and(p, p, c);
+    }
+    co->R[j] = Rj;
+
+    free_cubelist(T1);
+    free_cover(T);
+    free_cube(c);
+}
+
+/*
+ *  complement_outputs -- the complement of F u D, computed for each output
+ *  on its own (on up to num_threads threads)
+ *
+ *  This avoids splitting on the output variable at the top of the
+ *  recursion, and each output only sees its own cubes.  The complements
+ *  are then merged: cubes with the same input part get all their outputs.
+ */
+pcover complement_outputs(pcover F, pcover D) {
+    compl_output_t co;
+    int j, nout = cube.part_size[cube.output];
+    pcover R;
+
+    co.F = F;
+    co.D = D;
+    co.R = ALLOC(pcover, nout);
+    parallel_for(nout, num_threads, compl_output, &co);
+
+    R = new_cover(0);
+    for (j = 0; j < nout; j++) {
+        R = sf_append(R, co.R[j]);
+    }
+    FREE(co.R);
+    return d1merge(R, cube.output);
+}
+
+/*
+ *  compact_offset -- make the OFF-set R of F u D smaller
+ *
+ *  Every expand() of the minimization scans all of R, so a smaller R
+ *  makes each of them cheaper.  The cubes which differ in a single
+ *  variable are merged (while that removes cubes), then each cube is
+ *  expanded against F u D, which deletes the cubes covered by the
+ *  expansions.  An irredundant cover of R would often be smaller still,
+ *  but it can take far longer than the minimization itself.
+ */
+pcover compact_offset(pcover R, pcover F, pcover D) {
+    pcube last, p;
+    pcover FD;
+
+    R = d1merge_all(R);
+    foreach_set(R, last, p) {
+        RESET(p, PRIME);
+    }
+    FD = sf_join(F, D);
+    R = expand(R, FD, FALSE);
+    free_cover(FD);
+    return R;
+}
+
+/* compute_offset -- the OFF-set of the function with ON-set F, DC-set D */
+pcover compute_offset(pcover F, pcover D) {
+    pcover R;
+
+    if (offset_by_output && cube.output != -1 &&
+        cube.part_size[cube.output] > 1) {
+        R = complement_outputs(F, D);
+    } else {
+        R = complement(cube2list(F, D));
+    }
+    if (shrink_offset) {
+        R = compact_offset(R, F, D);
+    }
+    return R;
+}
@@ -11,6 +11,10 @@
     comparing each cube to its neighbor.  Finally, because the cubes
     are sorted by size, we need only check cubes which are larger (or
     smaller) than a given cube for containment.
+
+    For large families, the sets already kept are indexed (see
+    contain_index) so that each set is checked only against the sets
+    which could contain it (or be contained by it).
 */
 
 #include "espresso.h"
@@ -83,13 +87,141 @@ int rm_equal(pset *A1, /* updated in place */
     return pdest - A1;
 }
 
+/* families smaller than this are checked pair by pair */
+#define CONTAIN_INDEX_MIN 64
+
+/*
+    contain_index -- rm_contain and rm_rev_contain for large families
+
+    A set b can contain a only if every bit which is 0 in b is 0 in a.
+    Each kept set b is therefore filed under a single one of its 0 bits
+    (the one which is 0 in the fewest sets of the family), and a set a is
+    checked only against the sets filed under the 0 bits of a.  For
+    rev_contain the roles of 0 and 1 are swapped.  A 64-bit signature
+    (the words of the set or-ed together) rejects most of the remaining
+    candidates before the full set_implies.
+
+    The sets of one size are filed only once all of them have been seen,
+    exactly like pcheck in the pair by pair loops, so the result is the
+    same.
+*/
+typedef struct {
+    pset set;
+    unsigned long long sig;
+} index_entry_t;
+
+static unsigned long long set_signature(pset p) {
+    unsigned long long sig = 0;
+    int i;
+
+    for (i = LOOP(p); i > 0; i--)
+        sig |= (unsigned long long)p[i] << (i % 2 * BPI);
+    return sig;
+}
+
+/* key_word -- the bits under which a set is filed, in word i */
+#define key_word(p, i, rev) ((rev) ? (p)[i] : ~(p)[i])
+
+/* index_hit -- TRUE if a set in the list contains a (rev: is in a) */
+static bool index_hit(index_entry_t *e, int n, pset a, unsigned long long sig,
+                      bool rev) {
+    for (; n-- > 0; e++) {
+        if (rev) {
+            if ((e->sig & ~sig) == 0 && setp_implies(e->set, a))
+                return TRUE;
+        } else {
+            if ((sig & ~e->sig) == 0 && setp_implies(a, e->set))
+                return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static int contain_index(pset *A1, int n, bool rev) {
+    pset *pa, *pdest = A1, *pfile = A1, a, b;
+    index_entry_t **list;
+    int *count, *alloc, *freq;
+    int words, nbits, last_size = -1, i, k, best;
+    unsigned int w;
+    unsigned long long sig;
+    bool found;
+
+    words = LOOP(A1[0]);
+    nbits = words * BPI; /* list nbits holds the sets without key bits */
+    list = ALLOC(index_entry_t *, nbits + 1);
+    count = ALLOC(int, nbits + 1);
+    alloc = ALLOC(int, nbits + 1);
+    freq = ALLOC(int, nbits);
+    for (k = 0; k <= nbits; k++) {
+        list[k] = NIL(index_entry_t);
+        count[k] = alloc[k] = 0;
+    }
+    for (k = 0; k < nbits; k++)
+        freq[k] = 0;
+    for (pa = A1; pa != A1 + n; pa++)
+        for (i = 1; i <= words; i++)
+            for (w = key_word(*pa, i, rev), k = (i - 1) * BPI; w != 0;
+                 w >>= 1, k++)
+                if (w & 1)
+                    freq[k]++;
+
+    for (pa = A1; (a = *pa++) != NULL;) {
+        /* File the sets kept so far once the size changes */
+        if (SIZE(a) != last_size) {
+            last_size = SIZE(a);
+            for (; pfile != pdest; pfile++) {
+                b = *pfile;
+                best = nbits;
+                for (i = 1; i <= words; i++)
+                    for (w = key_word(b, i, rev), k = (i - 1) * BPI; w != 0;
+                         w >>= 1, k++)
+                        if ((w & 1) && (best == nbits || freq[k] < freq[best]))
+                            best = k;
+                if (count[best] == alloc[best]) {
+                    alloc[best] = alloc[best] * 2 + 4;
+                    list[best] =
+                        REALLOC(index_entry_t, list[best], alloc[best]);
+                }
+                list[best][count[best]].set = b;
+                list[best][count[best]++].sig = set_signature(b);
+            }
+        }
+
+        /* Check a against the sets filed under its key bits */
+        sig = set_signature(a);
+        found = index_hit(list[nbits], count[nbits], a, sig, rev);
+        for (i = 1; i <= words && !found; i++)
+            for (w = key_word(a, i, rev), k = (i - 1) * BPI; w != 0 && !found;
+                 w >>= 1, k++)
+                if (w & 1)
+                    found = index_hit(list[k], count[k], a, sig, rev);
+        if (!found)
+            *pdest++ = a;
+    }
+    *pdest = NULL;
+
+    for (k = 0; k <= nbits; k++)
+        if (list[k] != NIL(index_entry_t))
+            FREE(list[k]);
+    FREE(list);
+    FREE(count);
+    FREE(alloc);
+    FREE(freq);
+    return pdest - A1;
+}
+
 /* rm_contain -- perform containment over a sorted array of set pointers */
 int rm_contain(pset *A1 /* updated in place */
 ) {
-    pset *pa, *pb, *pcheck, a, b;
+    pset *pa, *pb, *pcheck = A1, a, b;
     pset *pdest = A1;
     int last_size = -1;
 
+    for (pa = A1; *pa != NULL; pa++)
+        ;
+    if (pa - A1 >= CONTAIN_INDEX_MIN)
+        return contain_index(A1, pa - A1, FALSE);
+
     /* Loop for all cubes of A1 */
     for (pa = A1; (a = *pa++) != NULL;) {
         /* Update the check pointer if the size has changed */
@@ -112,10 +244,15 @@ int rm_contain(pset *A1 /* updated in place */
 /* rm_rev_contain -- perform rcontainment over a sorted array of set pointers */
 int rm_rev_contain(pset *A1 /* updated in place */
 ) {
-    pset *pa, *pb, *pcheck, a, b;
+    pset *pa, *pb, *pcheck = A1, a, b;
     pset *pdest = A1;
     int last_size = -1;
 
+    for (pa = A1; *pa != NULL; pa++)
+        ;
+    if (pa - A1 >= CONTAIN_INDEX_MIN)
+        return contain_index(A1, pa - A1, TRUE);
+
     /* Loop for all cubes of A1 */
     for (pa = A1; (a = *pa++) != NULL;) {
         /* Update the check pointer if the size has changed */
@@ -225,3 +362,61 @@ pset_family d1merge(pset_family A, /* disposes of A */
                     int var) {
     return dist_merge(A, cube.var_mask[var]);
 }
+
+/*
+    d1merge_hash -- distance-1 merge of A in variable var, like d1merge,
+    but the cubes are bucketed in a hash table (on their value outside
+    var) rather than sorted.  The merged cubes keep the order of the
+    first cube of each group.
+*/
+pset_family d1merge_hash(pset_family A, /* modifies A */
+                         int var) {
+    pset mask = cube.var_mask[var], p, q, last, *table;
+    unsigned long long h;
+    unsigned int size;
+    int i;
+
+    for (size = 2; size < 2 * (unsigned)A->count; size *= 2)
+        ;
+    table = ALLOC(pset, size);
+    for (i = 0; i < (int)size; i++)
+        table[i] = NULL;
+    set_copy(cube.temp[0], mask); /* for d1_order */
+
+    foreach_set(A, last, p) {
+        SET(p, ACTIVE);
+        h = 0xCBF29CE484222325ULL;
+        for (i = LOOP(p); i > 0; i--)
+            h = (h ^ (p[i] | mask[i])) * 0x100000001B3ULL;
+        for (i = (int)(h & (size - 1)); (q = table[i]) != NULL;
+             i = (i + 1) & (int)(size - 1)) {
+            if (d1_order(&p, &q) == 0)
+                break;
+        }
+        if (q == NULL) {
+            table[i] = p;
+        } else {
+            set_or(q, q, p);
+            RESET(p, ACTIVE);
+        }
+    }
+    FREE(table);
+    return sf_inactive(A);
+}
+
+/*
+    d1merge_all -- distance-1 merge of the cubes of A in each variable in
+    turn, followed by containment, repeated while cubes are removed
+*/
+pset_family d1merge_all(pset_family A /* disposes of A */
+) {
+    int var, count;
+
+    do {
+        count = A->count;
+        for (var = 0; var < cube.num_vars; var++)
+            A = d1merge_hash(A, var);
+        A = sf_contain(A);
+    } while (A->count < count);
+    return A;
+}
@@ -16,6 +16,7 @@ void cube_setup() {
     int i, var;
     pcube p;
 
+    taut_cache_flush(); /* the answers were for another structure */
     cube.output = cube.num_vars - 1;
     cube.size = 0;
     cube.first_part = ALLOC(int, cube.num_vars);
@@ -67,6 +68,25 @@ void cube_setup() {
     cdata.is_unate = ALLOC(int, cube.num_vars);
 }
 
+/*
+    cube_setup_copy -- set up the cube structure of the calling thread as a
+    copy of "from", which is usually the cube structure of another thread.
+    Sets built under either structure can be used with the other one.
+    The copy is released with FREE(cube.part_size) and setdown_cube().
+*/
+void cube_setup_copy(struct cube_struct *from) {
+    int var;
+
+    cube.num_vars = from->num_vars;
+    cube.num_binary_vars = from->num_binary_vars;
+    cube.part_size = ALLOC(int, cube.num_vars);
+    for (var = 0; var < cube.num_vars; var++)
+        cube.part_size[var] = from->part_size[var];
+    cube_setup();
+    for (var = 0; var < cube.num_vars; var++)
+        cube.sparse[var] = from->sparse[var];
+}
+
 /*
     setdown_cube -- free memory allocated for the cube/cdata structs
     (free's all but the part_size array)
@@ -77,6 +97,8 @@ void cube_setup() {
 void setdown_cube() {
     int i, var;
 
+    taut_cache_flush();
+
     FREE(cube.first_part);
     FREE(cube.last_part);
     FREE(cube.first_word);
@@ -156,6 +156,7 @@ void parse_pla(FILE *fp, pPLA PLA) {
 
     lineno = 1;
     line_length_error = FALSE;
+    pla_type = TYPE_FD; /* unless .type says otherwise */
 
 loop:
     switch (ch = getc(fp)) {
@@ -200,12 +201,18 @@ loop:
                     if (cube.part_size[cube.num_vars - 1] <= 0)
                         fatal("silly value in .i");
                     cube_setup();
+                    /* a PLA with no cubes is an empty cover, not EOF */
+                    PLA->F = new_cover(10);
+                    PLA->D = new_cover(10);
+                    PLA->R = new_cover(10);
                 }
 
                 /* .type specifies a logical type for the PLA */
             } else if (equal(word, "type")) {
                 (void)get_word(fp, word);
-                if (equal(word, "fd")) {
+                if (equal(word, "f")) {
+                    pla_type = TYPE_F;
+                } else if (equal(word, "fd")) {
                     pla_type = TYPE_FD;
                 } else if (equal(word, "fr")) {
                     pla_type = TYPE_FR;
@@ -249,13 +256,16 @@ loop:
 
     Returns the PLA in the variable PLA after massaging the "symbolic"
     representation into a positional cube notation of the ON-set, OFF-set,
-    and the DC-set.
+    and the DC-set.  If needs_offset is FALSE, the OFF-set of a type fd
+    PLA is not computed, and PLA->R is NULL.  If merge_onset is set, the
+    cubes of the ON-set which differ in one variable are merged first (see
+    d1merge_all), which collapses an ON-set given minterm by minterm.
 
     Returns a status code as a result:
         EOF (-1) : End of file reached before any data was read
         > 0	 : Operation successful
 */
-int read_pla(FILE *fp, pPLA *PLA_return) {
+int read_pla(FILE *fp, bool needs_offset, pPLA *PLA_return) {
     pPLA PLA;
     int i;
 
@@ -275,9 +285,16 @@ int read_pla(FILE *fp, pPLA *PLA_return) {
         cube.part_size[i] = ABS(cube.part_size[i]);
     }
 
-    if (pla_type == TYPE_FD) {
+    if (merge_onset) {
+        PLA->F = d1merge_all(PLA->F);
+    }
+
+    if (pla_type == TYPE_F || pla_type == TYPE_FD) {
         free_cover(PLA->R);
-        PLA->R = complement(cube2list(PLA->F, PLA->D));  // R = U - (F u D)
+        PLA->R = NULL;
+        if (needs_offset) {
+            PLA->R = compute_offset(PLA->F, PLA->D); // R = U - (F u D)
+        }
     } else if (pla_type == TYPE_FR) {
         pcover X;
         free_cover(PLA->D);
@@ -285,6 +302,9 @@ int read_pla(FILE *fp, pPLA *PLA_return) {
         X = d1merge(sf_join(PLA->F, PLA->R), cube.num_vars - 1);
         PLA->D = complement(cube1list(X));
         free_cover(X);
+        if (shrink_offset) {
+            PLA->R = compact_offset(PLA->R, PLA->F, PLA->D);
+        }
     }
 
     return 1;
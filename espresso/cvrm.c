@@ -157,32 +157,33 @@ int cubelist_partition(pcube *T, /* a list of cubes */
                        pcube **B /* cubelist of partition and remainder */) {
     pcube *T1, p, seed, cof;
     pcube *A1, *B1;
-    bool change;
-    int count, numcube;
+    bool change, *in;
+    int count, numcube, i;
 
     numcube = CUBELISTSIZE(T);
 
-    /* Mark all cubes -- covered cubes belong to the partition */
-    for (T1 = T + 2; (p = *T1++) != NULL;) {
-        RESET(p, COVERED);
-    }
-
     /*
      *  Extract a partition from the cubelist T; start with the first cube as a
      *  seed, and then pull in all cubes which share a variable with the seed;
-     *  iterate until no new cubes are brought into the partition.
+     *  iterate until no new cubes are brought into the partition.  The cubes
+     *  of the partition are marked in "in" rather than by their flags, as the
+     *  cubes may be shared with other threads (see reduce_parallel).
      */
+    in = ALLOC(bool, numcube);
+    for (i = 0; i < numcube; i++) {
+        in[i] = FALSE;
+    }
     seed = set_save(T[2]);
     cof = T[0];
-    SET(T[2], COVERED);
+    in[0] = TRUE;
     count = 1;
 
     do {
         change = FALSE;
-        for (T1 = T + 2; (p = *T1++) != NULL;) {
-            if (!TESTP(p, COVERED) && ccommon(p, seed, cof)) {
+        for (T1 = T + 2, i = 0; (p = *T1++) != NULL; i++) {
+            if (!in[i] && ccommon(p, seed, cof)) {
                 INLINEset_and(seed, seed, p);
-                SET(p, COVERED);
+                in[i] = TRUE;
                 change = TRUE;
                 count++;
             }
@@ -201,8 +202,8 @@ int cubelist_partition(pcube *T, /* a list of cubes */
         B1 = *B + 2;
 
         /* Loop over the cubes in T and distribute to A and B */
-        for (T1 = T + 2; (p = *T1++) != NULL;) {
-            if (TESTP(p, COVERED)) {
+        for (T1 = T + 2, i = 0; (p = *T1++) != NULL; i++) {
+            if (in[i]) {
                 *A1++ = p;
             } else {
                 *B1++ = p;
@@ -216,5 +217,6 @@ int cubelist_partition(pcube *T, /* a list of cubes */
         (*B)[1] = (pcube)B1;
     }
 
+    FREE(in);
     return numcube - count;
 }
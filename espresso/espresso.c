@@ -6,51 +6,104 @@
  *
  *  The following global variables affect the operation of Espresso:
  *
- *  MISCELLANEOUS:
- *      trace
- *          print trace information as the minimization progresses
+ *  STRATEGY:
+ *      effort
+ *          EFFORT_FAST: stop after the first expand/irredundant (no
+ *          essential primes, last_gasp or make_sparse)
  *
- *      remove_essential
- *          remove essential primes
+ *          EFFORT_NORMAL: one round of reduce/expand/irredundant followed
+ *          by one last_gasp, then make_sparse
  *
- *      single_expand
- *          if true, stop after first expand/irredundant
+ *          EFFORT_STRONG: after the same first round as EFFORT_NORMAL,
+ *          repeat reduce/expand/irredundant while the number of cubes
+ *          decreases, and last_gasp while the cost decreases -- giving
+ *          last_gasp STRONG_GASP_ROUNDS further tries after it stops
+ *          improving -- then make_sparse on the cheapest cover seen along
+ *          the way (the last rounds may leave a worse one)
  *
- *  LAST_GASP or SUPER_GASP strategy:
- *      use_super_gasp
- *          uses the super_gasp strategy rather than last_gasp
- *
- *  SETUP strategy:
- *      recompute_onset
- *          recompute onset using the complement before starting
+ *      plateau_gain
+ *          EFFORT_STRONG: stop the outer loop when a round of it removes
+ *          less than this fraction of the literals
  *
  *      unwrap_onset
- *          unwrap the function output part before first expand
+ *          unravel the output part before the first expand, unless that
+ *          would produce too many cubes; if the final cover is then larger
+ *          than the original function, the minimization is repeated
+ *          without it (thread-local, so that portfolio variants differ)
+ *
+ *  DC-SET:
+ *      shrink_dcset
+ *          merge the cubes of the scratch copy of the DC-set which
+ *          differ in one variable (see d1merge_all), at the start and
+ *          again once essential() has added the essential primes to it;
+ *          every cube2list(F, D) is then shorter
  *
- *  MAKE_SPARSE strategy:
- *      force_irredundant
- *          iterates make_sparse to force a minimal solution (used
- *          indirectly by make_sparse)
+ *  OFF-SET:
+ *      R may be NULL (see lazy_offset), for functions whose OFF-set is
+ *      too large to compute.  expand_lazy() then takes the place of
+ *      expand(), checking each raise against F u D, and last_gasp (which
+ *      needs the OFF-set to look for expansions) is skipped.
  *
- *      skip_make_sparse
- *          skip the make_sparse step (used by opo only)
+ *  BUDGET:
+ *      time_limit, iteration_limit
+ *          stop at the next safe point once time_limit seconds have
+ *          passed (see budget.c), or after iteration_limit rounds of
+ *          reduce/expand/irredundant or last_gasp, and return the cover
+ *          found so far; budget_truncated is then set
  */
 
 #include "espresso.h"
 
+#define STRONG_GASP_ROUNDS 2
+
+/* expand_any -- expand F against R, or against F u D if R is NULL */
+static pcover expand_any(pcover F, pcover D, pcover R) {
+    return R != NULL ? expand(F, R, FALSE) : expand_lazy(F, D, FALSE);
+}
+
+/* cheaper -- TRUE if cost a is lower than cost b (cubes, then literals) */
+static bool cheaper(pcost a, pcost b) {
+    return a->cubes < b->cubes ||
+           (a->cubes == b->cubes && a->total < b->total);
+}
+
+/* keep_best -- save a copy of F in *best if it is the cheapest cover yet */
+static void keep_best(pcover F, pcost cost, pcover *best, pcost best_cost) {
+    if (*best == NULL || cheaper(cost, best_cost)) {
+        if (*best != NULL) {
+            free_cover(*best);
+        }
+        *best = sf_save(F);
+        copy_cost(cost, best_cost);
+    }
+}
+
+/* plateau -- TRUE if going from cost "before" to "after" gained too little */
+static bool plateau(pcost before, pcost after) {
+    return plateau_gain > 0 &&
+           before->total - after->total < plateau_gain * before->total;
+}
+
 pcover espresso(pcover F, pcover D1, pcover R) {
-    pcover E, D, Fsave;
+    pcover E, D, Fsave, Fbest, Ffirst;
     pset last, p;
-    cost_t cost, best_cost;
-    bool unwrap_onset = TRUE;
+    cost_t cost, best_cost, round_cost, Fbest_cost;
+    bool unwrap = unwrap_onset, improved, order = reduce_get_order();
+    int iterations, gasps_left, rounds;
 
 begin:
+    iterations = rounds = 0;
+    gasps_left = STRONG_GASP_ROUNDS;
+    Fbest = Ffirst = NULL;
     Fsave = sf_save(F); /* save original function */
     D = sf_save(D1);    /* make a scratch copy of D */
+    if (shrink_dcset) {
+        D = d1merge_all(D);
+    }
 
     /* Setup has always been a problem */
     cover_cost(F, &cost);
-    if (unwrap_onset && (cube.part_size[cube.num_vars - 1] > 1) &&
+    if (unwrap && (cube.part_size[cube.num_vars - 1] > 1) &&
         (cost.out != cost.cubes * cube.part_size[cube.num_vars - 1]) &&
         (cost.out < 5000))
         F = sf_contain(unravel(F, cube.num_vars - 1));
@@ -59,30 +112,88 @@ begin:
     foreach_set(F, last, p) {
         RESET(p, PRIME);
     }
-    F = expand(F, R, FALSE);
+    F = expand_any(F, D, R);
     F = irredundant(F, D);
+    if (budget_check(F, NIL(set_family_t)) || iterations == iteration_limit) {
+        E = new_cover(0);
+        goto truncated;
+    }
+    if (effort == EFFORT_FAST) {
+        E = new_cover(0);
+        goto stop;
+    }
 
     E = essential(&F, &D);
+    if (shrink_dcset) {
+        D = d1merge_all(D);
+    }
 
+    /*
+     *  With EFFORT_NORMAL the cost is not measured again inside the loops,
+     *  so that each of them makes exactly one pass.  EFFORT_STRONG makes
+     *  the same first round, so that it starts from the EFFORT_NORMAL cover.
+     */
     cover_cost(F, &cost);
     do {
+        copy_cost(&cost, &round_cost);
+
         /* Repeat inner loop until solution becomes "stable" */
         do {
             copy_cost(&cost, &best_cost);
             F = reduce(F, D);
-            F = expand(F, R, FALSE);
+            F = expand_any(F, D, R);
             F = irredundant(F, D);
+            if (budget_check(F, E) || ++iterations == iteration_limit) {
+                goto truncated;
+            }
+            if (effort == EFFORT_STRONG && rounds > 0) {
+                cover_cost(F, &cost);
+                keep_best(F, &cost, &Fbest, &Fbest_cost);
+            }
         } while (cost.cubes < best_cost.cubes);
 
         /* Perturb solution to see if we can continue to iterate */
         copy_cost(&cost, &best_cost);
 
-        F = last_gasp(F, D, R);
+        if (R != NULL) {
+            F = last_gasp(F, D, R);
+        }
+        if (budget_check(F, E) || ++iterations == iteration_limit) {
+            goto truncated;
+        }
+        if (effort == EFFORT_STRONG) {
+            cover_cost(F, &cost);
+            keep_best(F, &cost, &Fbest, &Fbest_cost);
+            if (rounds == 0) {
+                Ffirst = sf_save(F); /* the EFFORT_NORMAL cover */
+            }
+        }
+
+        improved = cheaper(&cost, &best_cost);
+        if (effort == EFFORT_STRONG) {
+            if (improved) {
+                gasps_left = STRONG_GASP_ROUNDS;
+            } else if (gasps_left-- > 0) {
+                improved = TRUE; /* try another round anyway */
+            }
+        }
+        rounds++;
+    } while (improved && !plateau(&round_cost, &cost));
 
-    } while (cost.cubes < best_cost.cubes ||
-             (cost.cubes == best_cost.cubes && cost.total < best_cost.total));
+    /* Go back to the cheapest cover if the last rounds made it worse */
+    if (Fbest != NULL) {
+        if (cheaper(&Fbest_cost, &cost)) {
+            free_cover(F);
+            F = Fbest;
+        } else {
+            free_cover(Fbest);
+        }
+    }
 
     /* Append the essential cubes to F */
+    if (Ffirst != NULL) {
+        Ffirst = sf_append(Ffirst, sf_save(E));
+    }
     F = sf_append(F, E); /* disposes of E */
 
     /* Free the D which we used */
@@ -91,6 +202,23 @@ begin:
     /* Attempt to make the PLA matrix sparse */
     F = make_sparse(F, D1, R);
 
+    /*
+     *  make_sparse may leave the cheapest cover above with more literals
+     *  than the EFFORT_NORMAL one, so EFFORT_STRONG returns the cheaper of
+     *  the two once both are sparse
+     */
+    if (Ffirst != NULL) {
+        Ffirst = make_sparse(Ffirst, D1, R);
+        cover_cost(F, &cost);
+        cover_cost(Ffirst, &Fbest_cost);
+        if (cheaper(&Fbest_cost, &cost)) {
+            free_cover(F);
+            F = Ffirst;
+        } else {
+            free_cover(Ffirst);
+        }
+    }
+
     /*
      *  Check to make sure function is actually smaller !!
      *  This can only happen because of the initial unravel.  If we fail,
@@ -99,11 +227,37 @@ begin:
     if (Fsave->count < F->count) {
         free_cover(F);
         F = Fsave;
-        unwrap_onset = FALSE;
+        unwrap = FALSE;
+        /* retry with the ordering one round would leave, at every effort */
+        reduce_set_order(!order);
         goto begin;
     } else {
         free_cover(Fsave);
     }
 
     return F;
+
+    /*
+     *  Out of budget (or EFFORT_FAST): F u E is a valid cover at each
+     *  budget_check, so return it as it stands (or the original function,
+     *  if the unravel left it larger), skipping make_sparse.
+     */
+truncated:
+    budget_truncated = TRUE;
+    if (Fbest != NULL) {
+        free_cover(Fbest);
+    }
+    if (Ffirst != NULL) {
+        free_cover(Ffirst);
+    }
+stop:
+    F = sf_append(F, E); /* disposes of E */
+    free_cover(D);
+    if (Fsave->count < F->count) {
+        free_cover(F);
+        F = Fsave;
+    } else {
+        free_cover(Fsave);
+    }
+    return F;
 }
@@ -243,10 +243,17 @@ typedef struct {
 } PLA_t, *pPLA;
 
 typedef enum {
+    TYPE_F,
     TYPE_FD,
     TYPE_FR,
 } pla_type_t;
 
+typedef enum {
+    EFFORT_FAST,
+    EFFORT_NORMAL,
+    EFFORT_STRONG,
+} effort_t;
+
 #define equal(a, b) (strcmp(a, b) == 0)
 
 /* This is a hack which I wish I hadn't done, but too painful to change */
@@ -295,12 +302,56 @@ struct cdata_struct {
     int best;          /* best "binate" variable */
 };
 
-extern struct cube_struct cube;
-extern struct cdata_struct cdata;
+extern _Thread_local struct cube_struct cube;
+extern _Thread_local struct cdata_struct cdata;
+
+extern effort_t effort;
+extern _Thread_local bool unwrap_onset;
+extern double plateau_gain;
+
+extern int portfolio_size;
+
+extern bool partition_outputs;
+extern bool reduce_support;
+extern bool fold_outputs;
+
+extern bool merge_onset;
+extern bool lazy_offset;
+extern bool offset_by_output;
+extern bool shrink_offset;
+extern bool shrink_dcset;
+extern bool taut_cache;
+extern int num_threads;
+
+extern double time_limit;
+extern int iteration_limit;
+extern _Atomic int budget_expired;
+extern _Thread_local bool budget_truncated;
+
+extern char *capture_dir;
+extern int capture_min_size;
+extern int capture_max_files;
 
 #define DISJOINT 0x55555555
 
 /* function declarations */
+/* blocking.c */
+void blocking_setup(pset_family BB);
+void blocking_free();
+void *blocking_swap(void *b);
+bool blocking_of(pset_family BB);
+bool blocking_reset(pset_family BB);
+void blocking_sync(pset_family BB);
+void blocking_essen_parts(pset RAISE, pset xlower);
+bool blocking_feasibly_covered(pset r, pset new_lower);
+void blocking_elim_lowering(pset r);
+void blocking_union(pset mask, pset result);
+/* budget.c */
+void budget_start();
+bool budget_check(pset_family F, pset_family E);
+/* capture.c */
+void capture_cubelist(char *kind, pset *T);
+void capture_matrix(char *kind, sm_matrix *A, int *weight, int heuristic);
 /* cofactor.c */
 pset *cofactor(pset *T, pset c);
 pset *scofactor(pset *T, pset c, int var);
@@ -312,6 +363,9 @@ pset *cube3list(pset_family A, pset_family B, pset_family C);
 pset_family cubeunlist(pset *A1);
 /* compl.c */
 pset_family complement(pset *T);
+pset_family complement_outputs(pset_family F, pset_family D);
+pset_family compact_offset(pset_family R, pset_family F, pset_family D);
+pset_family compute_offset(pset_family F, pset_family D);
 /* contain.c */
 pset_family sf_contain(pset_family A);
 pset_family sf_rev_contain(pset_family A);
@@ -323,15 +377,18 @@ pset *sf_sort(pset_family A, int (*compare)(pset *, pset *));
 pset *sf_list(pset_family A);
 pset_family sf_unlist(pset *A1, int totcnt, int size);
 pset_family d1merge(pset_family A, int var);
+pset_family d1merge_hash(pset_family A, int var);
+pset_family d1merge_all(pset_family A);
 /* cubestr.c */
 void cube_setup();
+void cube_setup_copy(struct cube_struct *from);
 void setdown_cube();
 /* cvrin.c */
 void skip_line(FILE *fpin);
 char *get_word(FILE *fp, char *word);
 void read_cube(FILE *fp, pPLA PLA);
 void parse_pla(FILE *fp, pPLA PLA);
-int read_pla(FILE *fp, pPLA *PLA_return);
+int read_pla(FILE *fp, bool needs_offset, pPLA *PLA_return);
 pPLA new_PLA();
 void free_PLA(pPLA PLA);
 /* cvrm.c */
@@ -356,6 +413,7 @@ pset_family cb_consensus(pset_family T, pset c);
 pset_family cb_consensus_dist0(pset_family R, pset p, pset c);
 /* expand.c */
 pset_family expand(pset_family F, pset_family R, int nonsparse);
+pset_family expand_lazy(pset_family F, pset_family D, int nonsparse);
 void expand1(pset_family BB, pset_family CC, pset RAISE, pset FREESET,
              pset OVEREXPANDED_CUBE, pset SUPER_CUBE, pset INIT_LOWER,
              int *num_covered, pset c);
@@ -384,8 +442,23 @@ sm_matrix *irred_derive_table(pset_family D, pset_family E, pset_family Rp);
 int cube_is_covered(pset *T, pset c);
 int tautology(pset *T);
 int taut_special_cases(pset *T);
+/* parallel.c */
+struct parallel_team;
+int parallel_threads(int nthreads);
+void parallel_for(int n, int nthreads, void (*fn)(int, void *), void *arg);
+struct parallel_team *parallel_start(int nthreads);
+int parallel_size(struct parallel_team *team);
+void parallel_run(struct parallel_team *team, void (*fn)(int, void *),
+                  void *arg);
+void parallel_stop(struct parallel_team *team);
+/* partition.c */
+pset_family espresso_partition(pset_family F, pset_family D, pset_family R);
+/* portfolio.c */
+pset_family espresso_portfolio(pset_family F, pset_family D1, pset_family R);
 /* reduce.c */
 pset_family reduce(pset_family F, pset_family D);
+void reduce_set_order(int use_sort_reduce);
+int reduce_get_order();
 pset reduce_cube(pset *FD, pset p);
 pset sccc(pset *T);
 pset sccc_merge(pset left, pset right, pset cl, pset cr);
@@ -436,8 +509,15 @@ pset do_sm_minimum_cover(pset_family A);
 /* sparse.c */
 pset_family make_sparse(pset_family F, pset_family D, pset_family R);
 pset_family mv_reduce(pset_family F, pset_family D);
+/* tautcache.c */
+int taut_cache_lookup(pset *T, void **pending);
+void taut_cache_store(void *pending, int result);
+void taut_cache_flush(void);
 /* unate.c */
 pset_family map_cover_to_unate(pset *T);
 pset_family map_unate_to_cover(pset_family A);
 pset_family unate_compl(pset_family A);
 pset_family unate_complement(pset_family A);
+/* verify.c */
+bool verify(pset_family F, pset_family Fold, pset_family Dold);
+int verify_pla(char *fname, FILE *fp);
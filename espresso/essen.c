@@ -5,6 +5,11 @@
 
 #include "espresso.h"
 
+/* smallest F u D for which essential() uses several threads */
+#define ESSEN_PARALLEL_MIN 256
+
+static bool essen_test(pcover FD, pcover D, pcube c);
+
 /*
     essential -- return a cover consisting of the cubes of F which are
     essential prime implicants (with respect to F u D); Further, remove
@@ -22,11 +27,30 @@
     cover are relatively essential, but we can mark the primes which
     were redundant at the start of irredundant and avoid an extra check
     on these primes for essentiality.
+
+    Whether a prime is essential depends only on F and D as they are on
+    entry, so with num_threads > 1 and a large F u D the primes are tested
+    on several threads (see essen_one); E is in the order of F either way.
 */
 
+typedef struct {
+    pcover F, FD, D; /* the function (read only) */
+    int *cand;       /* the primes to test (indices in F) */
+    bool *essen;     /* essen[k] -- whether prime cand[k] is essential */
+} essen_job_t;
+
+/* essen_one -- test the k-th candidate of essential() */
+static void essen_one(int k, void *data) {
+    essen_job_t *job = data;
+
+    job->essen[k] = essen_test(job->FD, job->D, GETSET(job->F, job->cand[k]));
+}
+
 pcover essential(pcover *Fp, pcover *Dp) {
-    pcube last, p;
+    pcube p;
     pcover E, F = *Fp, D = *Dp;
+    essen_job_t job;
+    int i, k, n;
 
     /* set all cubes in F active */
     (void)sf_active(F);
@@ -34,20 +58,36 @@ pcover essential(pcover *Fp, pcover *Dp) {
     /* Might as well start out with some cubes in E */
     E = new_cover(10);
 
-    foreach_set(F, last, p) {
-        /* don't test a prime which EXPAND says is nonessential */
-        if (!TESTP(p, NONESSEN)) {
-            /* only test a prime which was relatively essential */
-            if (TESTP(p, RELESSEN)) {
-                /* Check essentiality */
-                if (essen_cube(F, D, p)) {
-                    E = sf_addset(E, p);
-                    RESET(p, ACTIVE);
-                    F->active_count--;
-                }
-            }
+    /*
+     *  Don't test a prime which EXPAND says is nonessential, and only test
+     *  a prime which was relatively essential
+     */
+    job.cand = ALLOC(int, F->count + 1);
+    n = 0;
+    foreachi_set(F, i, p) {
+        if (!TESTP(p, NONESSEN) && TESTP(p, RELESSEN)) {
+            job.cand[n++] = i;
+        }
+    }
+
+    /* Check essentiality */
+    job.F = F;
+    job.D = D;
+    job.FD = sf_join(F, D);
+    job.essen = ALLOC(bool, n + 1);
+    parallel_for(n, job.FD->count >= ESSEN_PARALLEL_MIN ? num_threads : 1,
+                 essen_one, &job);
+    for (k = 0; k < n; k++) {
+        if (job.essen[k]) {
+            p = GETSET(F, job.cand[k]);
+            E = sf_addset(E, p);
+            RESET(p, ACTIVE);
+            F->active_count--;
         }
     }
+    free_cover(job.FD);
+    FREE(job.cand);
+    FREE(job.essen);
 
     *Fp = sf_inactive(F); /* delete the inactive cubes from F */
     *Dp = sf_join(D, E);  /* add the essentials to D */
@@ -65,14 +105,24 @@ pcover essential(pcover *Fp, pcover *Dp) {
     does not contain c.
 */
 bool essen_cube(pcover F, pcover D, pcube c) {
-    pcover H, FD;
-    pcube *H1;
+    pcover FD;
     bool essen;
 
-    /* Append F and D together, and take the sharp-consensus with c */
+    /* Append F and D together */
     FD = sf_join(F, D);
-    H = cb_consensus(FD, c);
+    essen = essen_test(FD, D, c);
     free_cover(FD);
+    return essen;
+}
+
+/* essen_test -- essen_cube() given F u D */
+static bool essen_test(pcover FD, pcover D, pcube c) {
+    pcover H;
+    pcube *H1;
+    bool essen;
+
+    /* Take the sharp-consensus with c */
+    H = cb_consensus(FD, c);
 
     /* Add the don't care set, and see if this covers c */
     H1 = cube2list(H, D);
@@ -11,7 +11,8 @@
 
     These routines revolve around having a representation of the
     OFF-set. (contrast to the Espresso-II manuscript, we do NOT
-    require an "unwrapped" version of the OFF-set).
+    require an "unwrapped" version of the OFF-set).  While expand() runs,
+    large OFF-sets are also kept by columns (see blocking.c).
 
     Some conventions on variable names:
 
@@ -31,11 +32,35 @@
 
 #include "espresso.h"
 
+/* most cubes of F expanded by each thread in one batch of expand_parallel */
+#define EXPAND_BATCH 8
+/* smallest OFF-set for which expand() uses several threads */
+#define EXPAND_PARALLEL_MIN 256
+
+static void expand_parallel(pcover F, pcover R, pcube INIT_LOWER,
+                            int nthreads);
+
+/* expand_accept -- replace p by RAISE, its expansion (see expand1) */
+static void expand_accept(pcube p, pcube RAISE, pcube OVEREXPANDED_CUBE,
+                          int num_covered) {
+    (void)set_copy(p, RAISE);
+    SET(p, PRIME);
+    RESET(p, COVERED); /* not really necessary */
+
+    /* See if we generated an inessential prime */
+    if (num_covered == 0 && !setp_equal(p, OVEREXPANDED_CUBE)) {
+        SET(p, NONESSEN);
+    }
+}
+
 /*
     expand -- expand each nonprime cube of F into a prime implicant
 
     If nonsparse is true, only the non-sparse variables will be expanded;
     this is done by forcing all of the sparse variables out of the free set.
+
+    With num_threads > 1 and a large OFF-set, the cubes are expanded on
+    several threads (see expand_parallel), with the same result.
 */
 
 pcover expand(pcover F, pcover R,
@@ -43,7 +68,7 @@ pcover expand(pcover F, pcover R,
 ) {
     pcube last, p;
     pcube RAISE, FREESET, INIT_LOWER, SUPER_CUBE, OVEREXPANDED_CUBE;
-    int var, num_covered;
+    int var, num_covered, nthreads, ncand;
     bool change;
 
     /* Order the cubes according to "chewing-away from the edges" of mini */
@@ -63,28 +88,31 @@ pcover expand(pcover F, pcover R,
                 (void)set_or(INIT_LOWER, INIT_LOWER, cube.var_mask[var]);
 
     /* Mark all cubes as not covered, and maybe essential */
+    ncand = 0;
     foreach_set(F, last, p) {
         RESET(p, COVERED);
         RESET(p, NONESSEN);
+        if (!TESTP(p, PRIME))
+            ncand++;
     }
 
     /* Try to expand each nonprime and noncovered cube */
-    foreach_set(F, last, p) {
-        /* do not expand if PRIME or if covered by previous expansion */
-        if (!TESTP(p, PRIME) && !TESTP(p, COVERED)) {
-            /* expand the cube p, result is RAISE */
-            expand1(R, F, RAISE, FREESET, OVEREXPANDED_CUBE, SUPER_CUBE,
-                    INIT_LOWER, &num_covered, p);
-            (void)set_copy(p, RAISE);
-            SET(p, PRIME);
-            RESET(p, COVERED); /* not really necessary */
-
-            /* See if we generated an inessential prime */
-            if (num_covered == 0 && !setp_equal(p, OVEREXPANDED_CUBE)) {
-                SET(p, NONESSEN);
+    blocking_setup(R);
+    nthreads = MIN(parallel_threads(num_threads), ncand);
+    if (nthreads > 1 && R->count >= EXPAND_PARALLEL_MIN) {
+        expand_parallel(F, R, INIT_LOWER, nthreads);
+    } else {
+        foreach_set(F, last, p) {
+            /* do not expand if PRIME or if covered by previous expansion */
+            if (!TESTP(p, PRIME) && !TESTP(p, COVERED)) {
+                /* expand the cube p, result is RAISE */
+                expand1(R, F, RAISE, FREESET, OVEREXPANDED_CUBE, SUPER_CUBE,
+                        INIT_LOWER, &num_covered, p);
+                expand_accept(p, RAISE, OVEREXPANDED_CUBE, num_covered);
             }
         }
     }
+    blocking_free();
 
     /* Delete any cubes of F which became covered during the expansion */
     F->active_count = 0;
@@ -109,6 +137,222 @@ pcover expand(pcover F, pcover R,
     return F;
 }
 
+/*
+    expand_parallel -- the loop of expand() on nthreads threads
+
+    The cubes are taken in batches: the next few cubes per thread (at most
+    EXPAND_BATCH) which are neither prime nor covered are expanded
+    concurrently, each thread using its own copy of R, and a copy of F as
+    it is at the start of the batch.  The expansions are then accepted in
+    the order of F, as the loop of expand() would:
+
+    - a cube covered by an earlier expansion is skipped;
+    - expand1() only looks at the cubes of F contained in the overexpanded
+      cube (elim_lowering drops the others before anything is chosen).  So
+      if none of the cubes which became prime or covered since the start
+      of the batch is contained in it, the expansion is the one expand()
+      would find, and is accepted.  Otherwise the cube is expanded again,
+      on the calling thread, against F as it is now.
+
+    The result is therefore the same as with a single thread.  The work
+    done for cubes which end up covered or expanded again is wasted, so
+    the batches are made smaller when much of a batch was wasted, and
+    larger again when little was.  The threads, and their copies of F and
+    R, are kept from one batch to the next (see parallel_start).
+*/
+typedef struct {
+    pcover F, R;   /* the copies of F and R of one thread */
+    void *matrix;  /* and its blocking matrix (see blocking.c) */
+} expand_slot_t;
+
+typedef struct {
+    pcover F, R;      /* the function (read only while expanding) */
+    pcube INIT_LOWER;
+    int nslots;
+    expand_slot_t *slot;
+    int ncand, *cand; /* the cubes of F expanded in this batch */
+    pcover raise;     /* raise[k] -- the expansion of cand[k] */
+    pcover over;      /* over[k] -- its overexpanded cube */
+    int *num_covered; /* the cubes it covers (count and indices in F) */
+    int **covers;
+    int ndirty, *dirty; /* the cubes of F changed since the last batch */
+} expand_batch_t;
+
+static void expand_speculate(int s, void *data) {
+    expand_batch_t *eb = data;
+    expand_slot_t *sl = &eb->slot[s];
+    pcube RAISE, FREESET, SUPER_CUBE, OVEREXPANDED_CUBE, c, p;
+    void *saved;
+    int i, k, n;
+
+    RAISE = new_cube();
+    FREESET = new_cube();
+    SUPER_CUBE = new_cube();
+    OVEREXPANDED_CUBE = new_cube();
+    if (sl->F == NIL(set_family_t)) {
+        sl->F = sf_save(eb->F);
+        sl->R = sf_save(eb->R);
+        sl->matrix = NULL;
+    } else {
+        for (i = 0; i < eb->ndirty; i++)
+            (void)set_copy(GETSET(sl->F, eb->dirty[i]),
+                           GETSET(eb->F, eb->dirty[i]));
+    }
+    saved = blocking_swap(sl->matrix);
+    if (sl->matrix == NULL)
+        blocking_setup(sl->R);
+
+    for (k = s; k < eb->ncand; k += eb->nslots) {
+        c = GETSET(sl->F, eb->cand[k]);
+        expand1(sl->R, sl->F, RAISE, FREESET, OVEREXPANDED_CUBE, SUPER_CUBE,
+                eb->INIT_LOWER, &eb->num_covered[k], c);
+        (void)set_copy(GETSET(eb->raise, k), RAISE);
+        (void)set_copy(GETSET(eb->over, k), OVEREXPANDED_CUBE);
+
+        /* Record the cubes covered, and put the copy of F back */
+        eb->covers[k] = ALLOC(int, eb->num_covered[k] + 1);
+        n = 0;
+        foreachi_set(sl->F, i, p) {
+            if (TESTP(p, COVERED) && !TESTP(GETSET(eb->F, i), COVERED)) {
+                eb->covers[k][n++] = i;
+                RESET(p, COVERED);
+            }
+        }
+        RESET(c, PRIME);
+    }
+
+    sl->matrix = blocking_swap(saved);
+    free_cube(RAISE);
+    free_cube(FREESET);
+    free_cube(SUPER_CUBE);
+    free_cube(OVEREXPANDED_CUBE);
+}
+
+static void expand_parallel(pcover F, pcover R, pcube INIT_LOWER,
+                            int nthreads) {
+    expand_batch_t eb;
+    struct parallel_team *team;
+    pcube RAISE, FREESET, SUPER_CUBE, OVEREXPANDED_CUBE, p, q, last;
+    pcover changed;
+    bool *covered, valid;
+    int i, j, k, next, num_covered, per_thread, wasted;
+    void *saved;
+
+    RAISE = new_cube();
+    FREESET = new_cube();
+    SUPER_CUBE = new_cube();
+    OVEREXPANDED_CUBE = new_cube();
+    team = parallel_start(nthreads);
+    nthreads = parallel_size(team);
+    eb.F = F;
+    eb.R = R;
+    eb.INIT_LOWER = INIT_LOWER;
+    eb.nslots = nthreads;
+    eb.slot = ALLOC(expand_slot_t, nthreads);
+    for (i = 0; i < nthreads; i++)
+        eb.slot[i].F = eb.slot[i].R = NIL(set_family_t);
+    eb.cand = ALLOC(int, nthreads * EXPAND_BATCH);
+    eb.raise = new_cover(nthreads * EXPAND_BATCH);
+    eb.over = new_cover(nthreads * EXPAND_BATCH);
+    eb.num_covered = ALLOC(int, nthreads * EXPAND_BATCH);
+    eb.covers = ALLOC(int *, nthreads * EXPAND_BATCH);
+    eb.dirty = ALLOC(int, F->count);
+    eb.ndirty = 0;
+    changed = new_cover(F->count);
+    covered = ALLOC(bool, F->count);
+    for (i = 0; i < F->count; i++)
+        covered[i] = FALSE;
+
+    per_thread = 1;
+    for (next = 0; next < F->count;) {
+        /* The next batch of cubes to expand */
+        eb.ncand = 0;
+        for (; next < F->count && eb.ncand < nthreads * per_thread; next++) {
+            p = GETSET(F, next);
+            if (!TESTP(p, PRIME) && !TESTP(p, COVERED))
+                eb.cand[eb.ncand++] = next;
+        }
+        if (eb.ncand == 0)
+            break;
+        eb.raise->count = eb.over->count = eb.ncand;
+        parallel_run(team, expand_speculate, &eb);
+
+        /* Accept the expansions in order */
+        changed->count = 0;
+        eb.ndirty = 0;
+        wasted = 0;
+        for (k = 0; k < eb.ncand; k++) {
+            p = GETSET(F, eb.cand[k]);
+            if (TESTP(p, COVERED)) {
+                wasted++;
+            } else {
+                valid = TRUE;
+                foreach_set(changed, last, q) {
+                    if (setp_implies(q, GETSET(eb.over, k))) {
+                        valid = FALSE;
+                        break;
+                    }
+                }
+                (void)set_copy(GETSET(changed, changed->count++), p);
+                eb.dirty[eb.ndirty++] = eb.cand[k];
+                if (valid) {
+                    expand_accept(p, GETSET(eb.raise, k), GETSET(eb.over, k),
+                                  eb.num_covered[k]);
+                    for (j = 0; j < eb.num_covered[k]; j++) {
+                        q = GETSET(F, eb.covers[k][j]);
+                        SET(q, COVERED);
+                        covered[eb.covers[k][j]] = TRUE;
+                        (void)set_copy(GETSET(changed, changed->count++), q);
+                        eb.dirty[eb.ndirty++] = eb.covers[k][j];
+                    }
+                } else {
+                    wasted++;
+                    expand1(R, F, RAISE, FREESET, OVEREXPANDED_CUBE,
+                            SUPER_CUBE, INIT_LOWER, &num_covered, p);
+                    expand_accept(p, RAISE, OVEREXPANDED_CUBE, num_covered);
+                    foreachi_set(F, i, q) {
+                        if (TESTP(q, COVERED) && !covered[i]) {
+                            covered[i] = TRUE;
+                            eb.dirty[eb.ndirty++] = i;
+                            (void)set_copy(GETSET(changed, changed->count++),
+                                           q);
+                        }
+                    }
+                }
+            }
+            FREE(eb.covers[k]);
+        }
+        if (4 * wasted > eb.ncand)
+            per_thread = MAX(per_thread / 2, 1);
+        else
+            per_thread = MIN(per_thread * 2, EXPAND_BATCH);
+    }
+
+    parallel_stop(team);
+    for (i = 0; i < nthreads; i++) {
+        if (eb.slot[i].F != NIL(set_family_t)) {
+            saved = blocking_swap(eb.slot[i].matrix);
+            blocking_free();
+            (void)blocking_swap(saved);
+            free_cover(eb.slot[i].F);
+            free_cover(eb.slot[i].R);
+        }
+    }
+    FREE(eb.slot);
+    FREE(eb.cand);
+    free_cover(eb.raise);
+    free_cover(eb.over);
+    FREE(eb.num_covered);
+    FREE(eb.covers);
+    FREE(eb.dirty);
+    free_cover(changed);
+    FREE(covered);
+    free_cube(RAISE);
+    free_cube(FREESET);
+    free_cube(SUPER_CUBE);
+    free_cube(OVEREXPANDED_CUBE);
+}
+
 /*
     expand1 -- Expand a single cube against the OFF-set
 */
@@ -189,6 +433,11 @@ void essen_parts(pcover BB, pcover CC, pcube RAISE, pcube FREESET) {
 
     (void)set_copy(xlower, cube.emptyset);
 
+    if (blocking_of(BB)) {
+        blocking_essen_parts(r, xlower);
+        goto lower;
+    }
+
     foreach_active_set(BB, lastp, p) {
 #ifdef NO_INLINE
         if ((dist = cdist01(p, r)) > 1)
@@ -236,6 +485,7 @@ void essen_parts(pcover BB, pcover CC, pcube RAISE, pcube FREESET) {
     exit_if:;
     }
 
+lower:
     if (!setp_empty(xlower)) {
         (void)set_diff(FREESET, FREESET, xlower); /* remove from free set */
         elim_lowering(BB, CC, RAISE, FREESET);
@@ -254,8 +504,12 @@ void essen_raising(pcover BB, pcube RAISE, pcube FREESET) {
     pcube last, p, xraise = cube.temp[0];
 
     /* Form union of all cubes of BB, and then take complement wrt FREESET */
-    (void)set_copy(xraise, cube.emptyset);
-    foreach_active_set(BB, last, p) INLINEset_or(xraise, xraise, p);
+    if (blocking_of(BB)) {
+        blocking_union(FREESET, xraise);
+    } else {
+        (void)set_copy(xraise, cube.emptyset);
+        foreach_active_set(BB, last, p) INLINEset_or(xraise, xraise, p);
+    }
     (void)set_diff(xraise, FREESET, xraise);
 
     (void)set_or(RAISE, RAISE, xraise);       /* add to raising set */
@@ -278,6 +532,10 @@ void elim_lowering(pcover BB, pcover CC, pcube RAISE, pcube FREESET) {
     /*
      *  Remove sets of BB which are orthogonal to future expansions
      */
+    if (blocking_of(BB)) {
+        blocking_elim_lowering(r);
+        goto lower_cc;
+    }
     foreach_active_set(BB, last, p) {
 #ifdef NO_INLINE
         if (!cdist0(p, r))
@@ -318,6 +576,7 @@ void elim_lowering(pcover BB, pcover CC, pcube RAISE, pcube FREESET) {
     /*
      *  Remove sets of CC which cannot be covered by future expansions
      */
+lower_cc:
     if (CC != (pcover)NULL) {
         foreach_active_set(CC, last, p) {
 #ifdef NO_INLINE
@@ -376,7 +635,8 @@ void setup_BB_CC(pcover BB, pcover CC) {
 
     /* Create the block and cover set families */
     BB->active_count = BB->count;
-    foreach_set(BB, last, p) SET(p, ACTIVE);
+    if (!blocking_reset(BB))
+        foreach_set(BB, last, p) SET(p, ACTIVE);
 
     if (CC != (pcover)NULL) {
         CC->active_count = CC->count;
@@ -387,6 +647,62 @@ void setup_BB_CC(pcover BB, pcover CC) {
     }
 }
 
+/* from this many fcc on, feas_counts() keeps the fcc by parts */
+#define FEAS_BY_PARTS 32
+
+/*
+    feas_counts -- for each fcc i, count the fcc which remain fcc after
+    raising i (those disjoint from feas_new_lower[i]).
+
+    Rather than testing every pair, the fcc are kept by parts: for each
+    part forced low by some fcc, a bit vector of the fcc which have the
+    part.  The fcc which are not disjoint from feas_new_lower[i] are the
+    union of the vectors of its parts.
+*/
+static void feas_counts(pcube *feas, pcube *feas_new_lower, int numfeas,
+                        int *count) {
+    pcube lowered = new_cube();
+    unsigned int *col, *hit, x;
+    int *parts, nparts, nwords, i, j, k, w;
+
+    for (i = 0; i < numfeas; i++)
+        INLINEset_or(lowered, lowered, feas_new_lower[i]);
+    parts = ALLOC(int, cube.size);
+    nparts = 0;
+    for (k = 0; k < cube.size; k++)
+        if (is_in_set(lowered, k))
+            parts[nparts++] = k;
+
+    nwords = (numfeas + BPI - 1) / BPI;
+    col = ALLOC(unsigned int, nparts * nwords + 1);
+    hit = ALLOC(unsigned int, nwords);
+    for (w = 0; w < nparts * nwords; w++)
+        col[w] = 0;
+    for (j = 0; j < numfeas; j++)
+        for (k = 0; k < nparts; k++)
+            if (is_in_set(feas[j], parts[k]))
+                col[k * nwords + j / BPI] |= 1U << (j % BPI);
+
+    for (i = 0; i < numfeas; i++) {
+        for (w = 0; w < nwords; w++)
+            hit[w] = 0;
+        for (k = 0; k < nparts; k++)
+            if (is_in_set(feas_new_lower[i], parts[k]))
+                for (w = 0; w < nwords; w++)
+                    hit[w] |= col[k * nwords + w];
+        count[i] = numfeas;
+        for (w = 0; w < nwords; w++) {
+            x = hit[w];
+            count[i] -= count_ones(x);
+        }
+    }
+
+    free_cube(lowered);
+    FREE(parts);
+    FREE(col);
+    FREE(hit);
+}
+
 /*
     select_feasible -- Determine if there are cubes which can be covered,
     and if so, raise those parts necessary to cover as many as possible.
@@ -398,8 +714,8 @@ void setup_BB_CC(pcover BB, pcover CC) {
 
 void select_feasible(pcover BB, pcover CC, pcube RAISE, pcube FREESET,
                      pcube SUPER_CUBE, int *num_covered) {
-    pcube p, last, bestfeas, *feas;
-    int i, j;
+    pcube p, last, bestfeas = NULL, *feas;
+    int i, j, *feas_count;
     pcube *feas_new_lower;
     int bestcount, bestsize, count, size, numfeas, lastfeas;
     pcover new_lower;
@@ -413,6 +729,7 @@ void select_feasible(pcover BB, pcover CC, pcube RAISE, pcube FREESET,
 
     /* Setup extra cubes to record parts forced low after a covering */
     feas_new_lower = ALLOC(pcube, CC->active_count);
+    feas_count = ALLOC(int, CC->active_count);
     new_lower = new_cover(numfeas);
     for (i = 0; i < numfeas; i++)
         feas_new_lower[i] = GETSET(new_lower, i);
@@ -453,6 +770,7 @@ loop:
     if (numfeas == 0) {
         FREE(feas);
         FREE(feas_new_lower);
+        FREE(feas_count);
         free_cover(new_lower);
         return;
     }
@@ -460,15 +778,20 @@ loop:
     /* Now find which is the best feasibly covered cube */
     bestcount = 0;
     bestsize = 9999;
+    if (numfeas >= FEAS_BY_PARTS)
+        feas_counts(feas, feas_new_lower, numfeas, feas_count);
     for (i = 0; i < numfeas; i++) {
         size = set_dist(feas[i], FREESET); /* # of newly raised parts */
         count = 0; /* # of other cubes which remain fcc after raising */
 
 #define NEW
 #ifdef NEW
-        for (j = 0; j < numfeas; j++)
-            if (setp_disjoint(feas_new_lower[i], feas[j]))
-                count++;
+        if (numfeas >= FEAS_BY_PARTS)
+            count = feas_count[i];
+        else
+            for (j = 0; j < numfeas; j++)
+                if (setp_disjoint(feas_new_lower[i], feas[j]))
+                    count++;
 #else
         for (j = 0; j < numfeas; j++)
             if (setp_implies(feas[j], feas[i]))
@@ -506,6 +829,8 @@ bool feasibly_covered(pcover BB, pcube c, pcube RAISE, pcube new_lower) {
     pcube lastp;
 
     set_copy(new_lower, cube.emptyset);
+    if (blocking_of(BB))
+        return blocking_feasibly_covered(r, new_lower);
     foreach_active_set(BB, lastp, p) {
 #ifdef NO_INLINE
         if ((dist = cdist01(p, r)) > 1)
@@ -580,6 +905,7 @@ void mincov(pcover BB, pcube RAISE, pcube FREESET) {
 #else
 
     /* Create B which are those cubes which we must avoid intersecting */
+    blocking_sync(BB);
     B = new_cover(BB->active_count);
     foreach_active_set(BB, last, p) {
         plower = set_copy(GETSET(B, B->count++), cube.emptyset);
@@ -622,3 +948,108 @@ heuristic_mincov:
     return;
 #endif
 }
+
+/*
+    expand_lazy -- expand each nonprime cube of F into a prime implicant,
+    without the OFF-set
+
+    A raise is feasible if the raised cube is still covered by F u D, which
+    is a tautology check on F u D cofactored against it.  First the cube
+    is raised to cover each cube of F at distance at most 1 from it (when
+    feasible), then each remaining part is tried in turn (the parts common
+    in F first).  When no part can be raised the cube is prime.  Cubes of
+    F covered by the prime are deleted; they are not marked with COVERED,
+    as the tautology checks use that flag.
+*/
+#define LAZY_TRIES 4
+
+pcover expand_lazy(pcover F, pcover D,
+                   bool nonsparse /* expand non-sparse variables only */
+) {
+    pcube p, q, RAISE, FREESET, ALLOWED, SUPER_CUBE, *FD;
+    int *count, *order, i, j, n, var, tries;
+    bool *covered, change;
+
+    F = mini_sort(F, ascend);
+
+    /* Order the parts which may be raised by their frequency in F */
+    count = sf_count(F);
+    order = ALLOC(int, cube.size);
+    FREESET = new_cube();
+    n = 0;
+    for (var = 0; var < cube.num_vars; var++) {
+        if (nonsparse && cube.sparse[var])
+            continue;
+        (void)set_or(FREESET, FREESET, cube.var_mask[var]);
+        for (i = cube.first_part[var]; i <= cube.last_part[var]; i++) {
+            for (j = n++; j > 0 && count[order[j - 1]] < count[i]; j--)
+                order[j] = order[j - 1];
+            order[j] = i;
+        }
+    }
+
+    covered = ALLOC(bool, F->count);
+    for (i = 0; i < F->count; i++)
+        covered[i] = FALSE;
+
+    /* Raise the parts of each nonprime and noncovered cube in turn */
+    RAISE = new_cube();
+    ALLOWED = new_cube();
+    SUPER_CUBE = new_cube();
+    FD = cube2list(F, D);
+    foreachi_set(F, i, p) {
+        if (!TESTP(p, PRIME) && !covered[i]) {
+            (void)set_copy(RAISE, p);
+            (void)set_or(ALLOWED, FREESET, p);
+            tries = 0;
+            foreachi_set(F, j, q) {
+                if (j != i && !covered[j] && !setp_implies(q, RAISE) &&
+                    setp_implies(q, ALLOWED) && cdist01(q, RAISE) <= 1) {
+                    if (cube_is_covered(FD, set_or(SUPER_CUBE, RAISE, q)))
+                        (void)set_copy(RAISE, SUPER_CUBE);
+                    if (++tries == LAZY_TRIES)
+                        break;
+                }
+            }
+            for (j = 0; j < n; j++) {
+                if (!is_in_set(RAISE, order[j])) {
+                    set_insert(RAISE, order[j]);
+                    if (!cube_is_covered(FD, RAISE))
+                        set_remove(RAISE, order[j]);
+                }
+            }
+            (void)set_copy(p, RAISE);
+            SET(p, PRIME);
+
+            foreachi_set(F, j, q) {
+                if (j != i && !covered[j] && setp_implies(q, p))
+                    covered[j] = TRUE;
+            }
+        }
+    }
+    free_cubelist(FD);
+
+    /* Delete any cubes of F which became covered during the expansion */
+    F->active_count = 0;
+    change = FALSE;
+    foreachi_set(F, i, p) {
+        if (covered[i]) {
+            RESET(p, ACTIVE);
+            change = TRUE;
+        } else {
+            SET(p, ACTIVE);
+            F->active_count++;
+        }
+    }
+    if (change)
+        F = sf_inactive(F);
+
+    free_cube(RAISE);
+    free_cube(FREESET);
+    free_cube(ALLOWED);
+    free_cube(SUPER_CUBE);
+    FREE(count);
+    FREE(order);
+    FREE(covered);
+    return F;
+}
@@ -13,10 +13,21 @@
     super_gasp is a variation on this strategy which extracts a minimal
     subset from the set of all prime implicants which cover all
     maximally reduced cubes.
+
+    The expansions of the reduced cubes are independent of each other, so
+    with num_threads > 1 they are done on several threads, each with its
+    own copy of the reduced cubes and the OFF-set (whose flags expand1_gasp
+    uses); the cubes found are put together in the order of F.
 */
 
 #include "espresso.h"
 
+/* smallest F for which expand_gasp() uses several threads */
+#define GASP_PARALLEL_MIN 64
+
+static void gasp_cube(pcover F, pcover R, pcover Foriginal, pcube *FD,
+                      int c1index, pcover *G);
+
 /*
  *  reduce_gasp -- compute the maximal reduction of each cube of F
  *
@@ -62,14 +73,59 @@ static pcover reduce_gasp(pcover F, pcover D) {
  *  regardless of whether they become covered or not.
  */
 
-pcover expand_gasp(pcover F, pcover D, pcover R, pcover Foriginal) {
+typedef struct {
+    pcover F, D, R, Foriginal; /* the function (read only) */
+    _Atomic int next;          /* the next cube of F to expand */
+    pcover *G;                 /* G[c1index] -- the cubes found for it */
+} gasp_job_t;
+
+/* gasp_worker -- expand the cubes of F handed out by job->next */
+static void gasp_worker(int s, void *data) {
+    gasp_job_t *job = data;
+    pcover F, R;
+    pcube *FD;
     int c1index;
+
+    (void)s;
+    F = sf_save(job->F);
+    R = sf_save(job->R);
+    FD = cube2list(job->Foriginal, job->D);
+    while ((c1index = job->next++) < F->count) {
+        job->G[c1index] = new_cover(1);
+        gasp_cube(F, R, job->Foriginal, FD, c1index, &job->G[c1index]);
+    }
+    free_cubelist(FD);
+    free_cover(F);
+    free_cover(R);
+}
+
+pcover expand_gasp(pcover F, pcover D, pcover R, pcover Foriginal) {
+    int c1index, nthreads;
     pcover G;
+    pcube *FD;
+    gasp_job_t job;
 
     /* Try to expand each nonprime and noncovered cube */
     G = new_cover(10);
-    for (c1index = 0; c1index < F->count; c1index++) {
-        expand1_gasp(F, D, R, Foriginal, c1index, &G);
+    nthreads = MIN(parallel_threads(num_threads), F->count);
+    if (nthreads > 1 && F->count >= GASP_PARALLEL_MIN) {
+        job.F = F;
+        job.D = D;
+        job.R = R;
+        job.Foriginal = Foriginal;
+        job.next = 0;
+        job.G = ALLOC(pcover, F->count);
+        parallel_for(nthreads, nthreads, gasp_worker, &job);
+        for (c1index = 0; c1index < F->count; c1index++) {
+            G = sf_append(G, job.G[c1index]);
+        }
+        FREE(job.G);
+    } else {
+        FD = cube2list(Foriginal, D);
+        for (c1index = 0; c1index < F->count; c1index++) {
+            gasp_cube(F, R, Foriginal, FD, c1index, &G);
+        }
+        free_cubelist(FD);
     }
     G = sf_dupl(G);
     G = expand(G, R, /*nonsparse*/ FALSE); /* Make them prime ! */
@@ -86,10 +142,24 @@ void expand1_gasp(
     pcover Foriginal, /* ON-set before reduction (same order as F) */
     int c1index,      /* which index of F (or Freduced) to be checked */
     pcover *G) {
+    pcube *FD;
+
+    FD = cube2list(Foriginal, D);
+    gasp_cube(F, R, Foriginal, FD, c1index, G);
+    free_cubelist(FD);
+}
+
+/*
+ *  gasp_cube -- expand1_gasp, given the cube list FD of Foriginal u D
+ */
+static void gasp_cube(pcover F, pcover R, pcover Foriginal, pcube *FD,
+                      int c1index, pcover *G) {
     int c2index;
     pcube p, last, c2under;
-    pcube RAISE, FREESET, temp, *FD, c2essential;
-    pcover F1;
+    pcube RAISE, FREESET, temp, c2essential;
+
+    /* Replace c1 with c1under in FD (the cubes of Foriginal come first) */
+    FD[2 + c1index] = GETSET(F, c1index);
 
     RAISE = new_cube();
     FREESET = new_cube();
@@ -131,15 +201,8 @@ void expand1_gasp(
                  * (F - c1) u c1under; if so, c2 can definitely be removed !
                  */
 
-                /* Copy F and replace c1 with c1under */
-                F1 = sf_save(Foriginal);
-                (void)set_copy(GETSET(F1, c1index), GETSET(F, c1index));
-
                 /* Reduce c2 against ((F - c1) u c1under) */
-                FD = cube2list(F1, D);
-                c2essential = reduce_cube(FD, GETSET(F1, c2index));
-                free_cubelist(FD);
-                sf_free(F1);
+                c2essential = reduce_cube(FD, GETSET(Foriginal, c2index));
 
                 /* See if c2essential is covered by an expansion of c1under */
                 if (feasibly_covered(R, c2essential, RAISE, temp)) {
@@ -152,6 +215,7 @@ void expand1_gasp(
         }
     }
 
+    FD[2 + c1index] = GETSET(Foriginal, c1index);
     free_cube(RAISE);
     free_cube(FREESET);
     free_cube(temp);
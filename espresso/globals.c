@@ -4,8 +4,45 @@
  *    Global Variable Declarations
  */
 
-struct cube_struct cube;
-struct cdata_struct cdata;
+/* each thread has its own cube structure (see cube_setup_copy) */
+_Thread_local struct cube_struct cube;
+_Thread_local struct cdata_struct cdata;
+
+/* minimization strategy (see espresso.c) */
+effort_t effort = EFFORT_NORMAL;
+_Thread_local bool unwrap_onset = TRUE; /* per thread, for the portfolio */
+double plateau_gain = 0; /* fraction of the literals, or 0 for no rule */
+
+/* portfolio (see portfolio.c) */
+int portfolio_size = 0; /* variants run by espresso_portfolio */
+
+/* output partitioning (see partition.c) */
+bool partition_outputs = FALSE; /* minimize independent outputs apart */
+bool reduce_support = FALSE;    /* leave out inputs without literals */
+bool fold_outputs = FALSE;      /* minimize one of each identical output */
+int num_threads = 1;            /* threads used for the components */
+
+/* merge the ON-set cubes as they are read (see cvrin.c) */
+bool merge_onset = FALSE;
+/* work without the OFF-set (see espresso.c) */
+bool lazy_offset = FALSE;
+/* compute the OFF-set one output at a time (see compl.c) */
+bool offset_by_output = FALSE;
+/* make the OFF-set smaller before using it (see compl.c) */
+bool shrink_offset = FALSE;
+/* make the DC-set smaller inside espresso() (see espresso.c) */
+bool shrink_dcset = FALSE;
+/* remember the answers of tautology() (see tautcache.c) */
+bool taut_cache = FALSE;
+
+/* run-time budget (see budget.c) */
+double time_limit = 0;    /* seconds, or 0 for no limit */
+int iteration_limit = -1; /* rounds of the espresso() loop, or -1 */
+
+/* subproblem capture (see capture.c) */
+char *capture_dir = NIL(char); /* directory for capture files, or NULL */
+int capture_min_size = 1000;   /* smallest cube list or table written */
+int capture_max_files = 100;   /* maximum number of files written */
 
 int bit_count[256] = {
     0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4,
@@ -1,6 +1,6 @@
 #include "espresso.h"
 
-static int Rp_current;
+static _Thread_local int Rp_current;
 
 /*
  *   irredundant -- Return a minimal subset of F
@@ -23,6 +23,9 @@ void mark_irredundant(pcover F, pcover D) {
     /* extract a minimum cover */
     irred_split_cover(F, D, &E, &Rt, &Rp);
     table = irred_derive_table(D, E, Rp);
+    if (capture_dir != NULL) {
+        capture_matrix("irred", table, NIL(int), 1);
+    }
     cover = sm_minimum_cover(table, NIL(int), /* heuristic */ 1);
 
     /* mark the cubes for the result */
@@ -232,7 +235,11 @@ sm_matrix *irred_derive_table(pcover D, pcover E, pcover Rp) {
 
 /* cube_is_covered -- determine if a cubelist "covers" a single cube */
 bool cube_is_covered(pcube *T, pcube c) {
-    return tautology(cofactor(T, c));
+    pcube *Tc = cofactor(T, c);
+    if (capture_dir != NULL) {
+        capture_cubelist("taut", Tc);
+    }
+    return tautology(Tc);
 }
 
 /* tautology -- answer the tautology question for T */
@@ -240,6 +247,13 @@ bool tautology(pcube *T /* T will be disposed of */
 ) {
     pcube cl, cr;
     int best, result;
+    void *pending = NULL;
+
+    /* see if the answer is known (see tautcache.c) */
+    if (taut_cache && (result = taut_cache_lookup(T, &pending)) != MAYBE) {
+        free_cubelist(T);
+        return result;
+    }
 
     if ((result = taut_special_cases(T)) == MAYBE) {
         cl = new_cube();
@@ -252,6 +266,9 @@ bool tautology(pcube *T /* T will be disposed of */
         free_cube(cr);
     }
 
+    if (pending != NULL) {
+        taut_cache_store(pending, result);
+    }
     return result;
 }
 
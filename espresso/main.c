@@ -1,11 +1,168 @@
 #include "espresso.h"
+#include <errno.h>
+#include <unistd.h>
 
-int main() {
+static void usage() {
+    fprintf(stderr, "usage: espresso [-e effort] [-p gain] [-P variants] "
+                    "[-d] [-s] [-f] [-m] [-n] [-O] [-R] [-D] [-T]\n"
+                    "                [-j threads] [-l seconds] "
+                    "[-i iterations] [-c dir] [-C size]\n"
+                    "                < file\n"
+                    "       espresso -v file < result\n");
+    fprintf(stderr, "  -e effort      fast, normal (default) or strong\n");
+    fprintf(stderr, "  -p gain        with -e strong, stop when a round gains "
+                    "less than\n"
+                    "                 this fraction of the literals\n");
+    fprintf(stderr, "  -P variants    run this many variants on separate "
+                    "threads, keep\n"
+                    "                 the best result\n");
+    fprintf(stderr, "  -d             minimize independent groups of outputs "
+                    "separately\n");
+    fprintf(stderr, "  -s             leave out the inputs which are '-' in "
+                    "every cube\n");
+    fprintf(stderr, "  -f             minimize only one of each set of "
+                    "identical outputs\n");
+    fprintf(stderr, "  -m             merge the ON-set cubes which differ "
+                    "in one variable\n"
+                    "                 before minimizing\n");
+    fprintf(stderr, "  -n             do not compute the OFF-set; expand "
+                    "with tautology\n"
+                    "                 checks instead\n");
+    fprintf(stderr, "  -O             compute the OFF-set one output at a "
+                    "time\n");
+    fprintf(stderr, "  -R             make the OFF-set smaller before "
+                    "minimizing\n");
+    fprintf(stderr, "  -D             make the DC-set smaller while "
+                    "minimizing\n");
+    fprintf(stderr, "  -T             remember the answers of tautology "
+                    "checks\n");
+    fprintf(stderr, "  -j threads     threads used for -d, -O, expand, "
+                    "reduce, essential\n"
+                    "                 primes, last gasp and sparse "
+                    "outputs\n");
+    fprintf(stderr, "  -l seconds     stop minimizing after this much time\n");
+    fprintf(stderr, "  -i iterations  stop after this many improvement "
+                    "rounds\n");
+    fprintf(stderr, "  -c dir         capture large subproblems into dir\n");
+    fprintf(stderr, "  -C size        smallest subproblem captured "
+                    "(default %d)\n",
+            capture_min_size);
+    fprintf(stderr, "  -v file        check that result is a cover of the "
+                    "PLA in file\n");
+    exit(2);
+}
+
+/* int_arg -- the integer argument s of an option, at least min */
+static int int_arg(const char *s, int min) {
+    char *end;
+    long v;
+
+    errno = 0;
+    v = strtol(s, &end, 10);
+    if (end == s || *end != '\0' || errno != 0 || v < min || v > INT_MAX) {
+        usage();
+    }
+    return (int)v;
+}
+
+/* real_arg -- the numeric argument s of an option, at least min */
+static double real_arg(const char *s, double min) {
+    char *end;
+    double v;
+
+    errno = 0;
+    v = strtod(s, &end);
+    if (end == s || *end != '\0' || errno != 0 || !(v >= min) ||
+        isinf(v)) {
+        usage();
+    }
+    return v;
+}
+
+int main(int argc, char **argv) {
     pPLA PLA;
+    int opt;
+    bool prepass;
+    char *verify_file = NIL(char);
+
+    while ((opt = getopt(argc, argv, "e:p:P:dsfmnORDTj:l:i:c:C:v:")) != -1) {
+        switch (opt) {
+            case 'e':
+                if (equal(optarg, "fast")) {
+                    effort = EFFORT_FAST;
+                } else if (equal(optarg, "normal")) {
+                    effort = EFFORT_NORMAL;
+                } else if (equal(optarg, "strong")) {
+                    effort = EFFORT_STRONG;
+                } else {
+                    usage();
+                }
+                break;
+            case 'p':
+                plateau_gain = real_arg(optarg, 0);
+                break;
+            case 'P':
+                portfolio_size = int_arg(optarg, 1);
+                break;
+            case 'd':
+                partition_outputs = TRUE;
+                break;
+            case 's':
+                reduce_support = TRUE;
+                break;
+            case 'f':
+                fold_outputs = TRUE;
+                break;
+            case 'm':
+                merge_onset = TRUE;
+                break;
+            case 'n':
+                lazy_offset = TRUE;
+                break;
+            case 'O':
+                offset_by_output = TRUE;
+                break;
+            case 'R':
+                shrink_offset = TRUE;
+                break;
+            case 'D':
+                shrink_dcset = TRUE;
+                break;
+            case 'T':
+                taut_cache = TRUE;
+                break;
+            case 'j':
+                num_threads = int_arg(optarg, 1);
+                break;
+            case 'l':
+                time_limit = real_arg(optarg, 0);
+                break;
+            case 'i':
+                iteration_limit = int_arg(optarg, 0);
+                break;
+            case 'c':
+                capture_dir = optarg;
+                break;
+            case 'C':
+                capture_min_size = int_arg(optarg, 0);
+                break;
+            case 'v':
+                verify_file = optarg;
+                break;
+            default:
+                usage();
+        }
+    }
 
     /* the remaining arguments are argv[optind ... argc-1] */
+    if (verify_file != NIL(char)) {
+        exit(verify_pla(verify_file, stdin));
+    }
+    budget_start();
     PLA = NIL(PLA_t);
-    if (read_pla(stdin, &PLA) == EOF) {
+    /* the pre-passes of espresso_partition() compute the off-set later */
+    prepass = partition_outputs || reduce_support || fold_outputs;
+    if (read_pla(stdin, !prepass && !lazy_offset, &PLA) == EOF) {
         fprintf(stderr, "Unable to find PLA on stdin\n");
         exit(1);
     }
@@ -13,9 +170,20 @@ int main() {
     /*
      *  Now run espresso
      */
-    PLA->F = espresso(PLA->F, PLA->D, PLA->R);
+    if (prepass) {
+        PLA->F = espresso_partition(PLA->F, PLA->D, PLA->R);
+    } else if (portfolio_size > 1) {
+        PLA->F = espresso_portfolio(PLA->F, PLA->D, PLA->R);
+    } else {
+        PLA->F = espresso(PLA->F, PLA->D, PLA->R);
+    }
 
     /* Output the solution */
+    if (budget_truncated) {
+        fprintf(stderr, "espresso: budget exhausted, result not fully "
+                        "minimized\n");
+        fprintf(stdout, "# espresso: truncated, not fully minimized\n");
+    }
     fprint_pla(stdout, PLA);
 
     /* cleanup all used memory */
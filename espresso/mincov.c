@@ -9,6 +9,9 @@
 
 static int select_column();
 
+int mincov_node_limit = 0;
+_Atomic int mincov_interrupt = 0;
+
 #define fail(why)                                                              \
     {                                                                          \
         (void)fprintf(stderr, "Fatal error: file %s, line %d\n%s\n", __FILE__, \
@@ -269,6 +272,12 @@ solution_t *sm_mincov(sm_matrix *A, solution_t *select, int *weight, int lb,
             return best1;
         }
 
+        /* Out of budget -- keep the best solution so far */
+        if (mincov_interrupt ||
+            (mincov_node_limit > 0 && stats->nodes >= mincov_node_limit)) {
+            return best1;
+        }
+
         /* Check for reaching lower bound -- if so, don't actually branch */
         if (best1 != NIL(solution_t) && best1->cost == lb_new) {
             return best1;
@@ -1 +1,7 @@
 sm_row *sm_minimum_cover(sm_matrix *A, int *weight, int heuristic);
+
+/* branch and bound limits: when either is reached, sm_minimum_cover stops
+   branching and returns the best cover found so far (a heuristic cover
+   does not branch, so they do not apply to it) */
+extern int mincov_node_limit;        /* nodes, or 0 for no limit */
+extern _Atomic int mincov_interrupt; /* may be set by a signal */
@@ -0,0 +1,263 @@
+/*
+    module: parallel.c
+    purpose: run independent pieces of work on several threads
+
+    parallel_for(n, nthreads, fn, arg) calls fn(i, arg) for i = 0 .. n-1,
+    using up to nthreads threads, and returns when all calls are done.
+    The calls are handed out in increasing order of i, but may complete in
+    any order, so fn must only write to storage private to its index.
+
+    Each worker thread gets its own copy of the caller's cube structure
+    (cube and cdata are thread-local, see cube_setup_copy), so fn may use
+    any of the espresso routines.  Set families can be passed between
+    threads, but a set family must not be modified by one thread while
+    another is using it (the flags of the cubes included).
+
+    With nthreads <= 1, or a single piece of work, fn is simply called in
+    the calling thread.  So it is when parallel_for is called from one of
+    its own worker threads: the outer call already keeps the threads busy
+    (see parallel_threads).  No more threads are used than there are
+    processors online, or than the environment variable ESPRESSO_CPUS
+    gives: the tests set it, so that they run threads on any machine.
+
+    The loops which hand out many small batches of work (expand, reduce)
+    use a team instead: parallel_start() starts the threads, which copy
+    the cube structure once, and each parallel_run(team, fn, arg) calls
+    fn(s, arg) once for each member s = 0 .. parallel_size(team)-1 of the
+    team, the calling thread being member 0, and returns when all calls
+    are done.  parallel_stop() ends the threads.
+*/
+
+#include "espresso.h"
+#include <pthread.h>
+#include <unistd.h>
+
+static _Thread_local bool in_worker; /* TRUE in the worker threads */
+
+typedef struct {
+    int n;                      /* number of pieces of work */
+    int next;                   /* next piece to hand out */
+    pthread_mutex_t lock;       /* protects next */
+    void (*fn)(int, void *);    /* the work */
+    void *arg;                  /* passed to fn */
+    struct cube_struct *parent; /* cube structure of the calling thread */
+} parallel_job_t;
+
+static void *parallel_worker(void *data) {
+    parallel_job_t *job = data;
+    int i;
+
+    cube_setup_copy(job->parent);
+    in_worker = TRUE;
+    for (;;) {
+        (void)pthread_mutex_lock(&job->lock);
+        i = job->next++;
+        (void)pthread_mutex_unlock(&job->lock);
+        if (i >= job->n) {
+            break;
+        }
+        job->fn(i, job->arg);
+    }
+    FREE(cube.part_size);
+    setdown_cube();
+    sf_cleanup();
+    return NULL;
+}
+
+/* online_cpus -- the number of processors online (1 if unknown) */
+static int online_cpus() {
+    static _Atomic int ncpus;
+    char *s, *end;
+    long n, v;
+
+    if (ncpus == 0) {
+        n = sysconf(_SC_NPROCESSORS_ONLN);
+        if ((s = getenv("ESPRESSO_CPUS")) != NULL) {
+            v = strtol(s, &end, 10);
+            if (end != s && *end == '\0' && v >= 1) {
+                n = v;
+            }
+        }
+        ncpus = n >= 1 && n <= INT_MAX ? (int)n : 1;
+    }
+    return ncpus;
+}
+
+/* parallel_threads -- the threads parallel_for would use for nthreads */
+int parallel_threads(int nthreads) {
+    if (in_worker) {
+        return 1;
+    }
+    return MIN(nthreads, online_cpus());
+}
+
+void parallel_for(int n, int nthreads, void (*fn)(int, void *), void *arg) {
+    parallel_job_t job;
+    pthread_t *tid;
+    int i, started;
+
+    nthreads = parallel_threads(nthreads);
+    if (nthreads > n) {
+        nthreads = n;
+    }
+    if (nthreads <= 1) {
+        for (i = 0; i < n; i++) {
+            fn(i, arg);
+        }
+        return;
+    }
+
+    job.n = n;
+    job.next = 0;
+    job.fn = fn;
+    job.arg = arg;
+    job.parent = &cube;
+    (void)pthread_mutex_init(&job.lock, NULL);
+
+    tid = ALLOC(pthread_t, nthreads);
+    for (started = 0; started < nthreads; started++) {
+        if (pthread_create(&tid[started], NULL, parallel_worker, &job) != 0) {
+            break;
+        }
+    }
+    if (started == 0) { /* no threads to be had, so do the work here */
+        for (i = 0; i < n; i++) {
+            fn(i, arg);
+        }
+    }
+    for (i = 0; i < started; i++) {
+        (void)pthread_join(tid[i], NULL);
+    }
+
+    (void)pthread_mutex_destroy(&job.lock);
+    FREE(tid);
+}
+
+struct parallel_team {
+    int size;                   /* members, the calling thread included */
+    pthread_t *tid;             /* the threads of members 1 .. size-1 */
+    pthread_mutex_t lock;       /* protects the fields below */
+    pthread_cond_t go, done;    /* a run has started, all calls are done */
+    int run;                    /* number of the current run */
+    int busy;                   /* threads still in the current run */
+    bool stop;                  /* TRUE once the threads should end */
+    void (*fn)(int, void *);    /* the work of the current run */
+    void *arg;                  /* passed to fn */
+    struct cube_struct *parent; /* cube structure of the calling thread */
+};
+
+typedef struct {
+    struct parallel_team *team;
+    int member;
+} team_member_t;
+
+static void *team_worker(void *data) {
+    team_member_t *m = data;
+    struct parallel_team *team = m->team;
+    int run = 0;
+
+    cube_setup_copy(team->parent);
+    in_worker = TRUE;
+    (void)pthread_mutex_lock(&team->lock);
+    for (;;) {
+        while (team->run == run && !team->stop) {
+            (void)pthread_cond_wait(&team->go, &team->lock);
+        }
+        if (team->stop) {
+            break;
+        }
+        run = team->run;
+        (void)pthread_mutex_unlock(&team->lock);
+        team->fn(m->member, team->arg);
+        (void)pthread_mutex_lock(&team->lock);
+        if (--team->busy == 0) {
+            (void)pthread_cond_signal(&team->done);
+        }
+    }
+    (void)pthread_mutex_unlock(&team->lock);
+    FREE(m);
+    FREE(cube.part_size);
+    setdown_cube();
+    sf_cleanup();
+    return NULL;
+}
+
+/* parallel_start -- start a team of (at most) nthreads threads */
+struct parallel_team *parallel_start(int nthreads) {
+    struct parallel_team *team;
+    team_member_t *m;
+
+    nthreads = parallel_threads(nthreads);
+    team = ALLOC(struct parallel_team, 1);
+    team->size = 1;
+    team->tid = ALLOC(pthread_t, MAX(nthreads, 1));
+    team->run = 0;
+    team->busy = 0;
+    team->stop = FALSE;
+    team->parent = &cube;
+    (void)pthread_mutex_init(&team->lock, NULL);
+    (void)pthread_cond_init(&team->go, NULL);
+    (void)pthread_cond_init(&team->done, NULL);
+    while (team->size < nthreads) {
+        m = ALLOC(team_member_t, 1);
+        m->team = team;
+        m->member = team->size;
+        if (pthread_create(&team->tid[team->size], NULL, team_worker, m) !=
+            0) {
+            FREE(m);
+            break; /* no more threads to be had */
+        }
+        team->size++;
+    }
+    return team;
+}
+
+/* parallel_size -- the number of members of team */
+int parallel_size(struct parallel_team *team) {
+    return team->size;
+}
+
+void parallel_run(struct parallel_team *team, void (*fn)(int, void *),
+                  void *arg) {
+    bool was_worker = in_worker;
+
+    if (team->size > 1) {
+        (void)pthread_mutex_lock(&team->lock);
+        team->fn = fn;
+        team->arg = arg;
+        team->busy = team->size - 1;
+        team->run++;
+        (void)pthread_cond_broadcast(&team->go);
+        (void)pthread_mutex_unlock(&team->lock);
+    }
+
+    in_worker = TRUE; /* member 0 is a worker as well */
+    fn(0, arg);
+    in_worker = was_worker;
+
+    if (team->size > 1) {
+        (void)pthread_mutex_lock(&team->lock);
+        while (team->busy > 0) {
+            (void)pthread_cond_wait(&team->done, &team->lock);
+        }
+        (void)pthread_mutex_unlock(&team->lock);
+    }
+}
+
+/* parallel_stop -- end the threads of team, and free it */
+void parallel_stop(struct parallel_team *team) {
+    int i;
+
+    (void)pthread_mutex_lock(&team->lock);
+    team->stop = TRUE;
+    (void)pthread_cond_broadcast(&team->go);
+    (void)pthread_mutex_unlock(&team->lock);
+    for (i = 1; i < team->size; i++) {
+        (void)pthread_join(team->tid[i], NULL);
+    }
+    (void)pthread_cond_destroy(&team->go);
+    (void)pthread_cond_destroy(&team->done);
+    (void)pthread_mutex_destroy(&team->lock);
+    FREE(team->tid);
+    FREE(team);
+}
@@ -0,0 +1,499 @@
+/*
+    module: partition.c
+    purpose: minimize independent groups of outputs separately
+
+    Two outputs are connected when a cube of the function has both of them,
+    or when cubes of the two have a literal of the same input.  The cubes of
+    F and D are looked at, and those of R as well when the off-set was
+    given.  Each connected component of outputs, together with the inputs
+    it uses, is a function of its own: no cube spans two components, so a
+    cover of the whole is the union of covers of the components.
+
+    espresso_partition() minimizes each component as a separate PLA, in a
+    cube structure with only the inputs and outputs of the component, on up
+    to num_threads threads.  The shorter cubes make every set operation
+    cheaper, and the complement of each component is computed on its own
+    (when R is NULL, unless lazy_offset), which is usually far smaller
+    than the complement of the whole.  The covers are then mapped back
+    into the full cube structure, with the output columns put back in
+    place.
+
+    With partition_outputs FALSE, all outputs are put in one component, so
+    only the support is reduced: the inputs which have no literal in any
+    cube (which are '-' throughout) are left out of the cube structure
+    while the function is minimized, and come back as '-' in the result.
+
+    With fold_outputs, outputs whose columns in F and D (and R, if given)
+    are identical are folded into the first of them before the components
+    are found: only that output is minimized, and the cubes of the result
+    get all of the outputs folded into it.
+
+    The cube structure of the component is set up within the thread that
+    minimizes it, and the thread's own structure is restored afterwards.
+    Only PLAs with binary inputs and a single output part are partitioned;
+    others, and PLAs which are a single component using every input, are
+    passed to espresso() as they are.
+*/
+
+#include "espresso.h"
+
+#define DASH 3 /* GETINPUT() of an input without a literal */
+
+typedef struct {
+    int ninputs;   /* number of inputs of the component */
+    int noutputs;  /* number of outputs of the component */
+    int *input;    /* the inputs, numbered as in the full structure */
+    int *output;   /* the outputs, numbered as in the full structure */
+    int cubes;     /* number of cubes of F, D and R in the component */
+} component_t;
+
+typedef struct {
+    pcover F, D, R;      /* the function, in the full cube structure */
+    int *comp_F;         /* the component of each cube of F (or -1) */
+    int *comp_D;         /* ... of D */
+    int *comp_R;         /* ... of R, if R is given */
+    int ncomp;           /* number of components */
+    component_t *comp;   /* the components */
+    int *order;          /* the components, largest first */
+    pcover *result;      /* the cover of each component (full structure) */
+    bool *truncated;     /* and whether its budget ran out */
+    int size;            /* cube.size of the full structure */
+    int num_inputs;      /* cube.num_binary_vars of the full structure */
+    int first_output;    /* first part of the output in the full structure */
+    int *rep;            /* the output each output is folded into */
+    int *next_dup;       /* the next output folded into the same one, or -1 */
+} partition_t;
+
+/* union-find on the outputs (0 .. nout-1) and inputs (nout ...) */
+static int uf_find(int *parent, int x) {
+    while (parent[x] != x) {
+        x = parent[x] = parent[parent[x]];
+    }
+    return x;
+}
+
+static void uf_union(int *parent, int x, int y) {
+    x = uf_find(parent, x);
+    y = uf_find(parent, y);
+    if (x < y) {
+        parent[y] = x;
+    } else if (y < x) {
+        parent[x] = y;
+    }
+}
+
+/* link_cubes -- connect the outputs and inputs used by each cube of T */
+static void link_cubes(pcover T, int *parent, int *rep) {
+    int nout = cube.part_size[cube.output];
+    int out0 = cube.first_part[cube.output];
+    int i, first;
+    pcube last, p;
+
+    foreach_set(T, last, p) {
+        first = -1;
+        for (i = 0; i < nout; i++) {
+            if (rep[i] == i && is_in_set(p, out0 + i)) {
+                if (first == -1) {
+                    first = i;
+                } else {
+                    uf_union(parent, first, i);
+                }
+            }
+        }
+        if (first != -1) {
+            for (i = 0; i < cube.num_binary_vars; i++) {
+                if (GETINPUT(p, i) != DASH) {
+                    uf_union(parent, first, nout + i);
+                }
+            }
+        }
+    }
+}
+
+/* assign_cubes -- record the component of each cube of T */
+static int *assign_cubes(pcover T, int *parent, int *comp_of,
+                         partition_t *pt) {
+    int nout = cube.part_size[cube.output];
+    int out0 = cube.first_part[cube.output];
+    int *comp = ALLOC(int, T->count), i, k;
+    pcube p;
+
+    foreachi_set(T, k, p) {
+        comp[k] = -1;
+        for (i = 0; i < nout; i++) {
+            if (pt->rep[i] == i && is_in_set(p, out0 + i)) {
+                comp[k] = comp_of[uf_find(parent, i)];
+                pt->comp[comp[k]].cubes++;
+                break;
+            }
+        }
+    }
+    return comp;
+}
+
+/* same_column -- do outputs a and b have the same column in T ? */
+static bool same_column(pcover T, int a, int b) {
+    int out0 = cube.first_part[cube.output];
+    pcube last, p;
+
+    foreach_set(T, last, p) {
+        if (!is_in_set(p, out0 + a) != !is_in_set(p, out0 + b)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* hash_columns -- mix the cubes of T which have each output into hash */
+static void hash_columns(pcover T, unsigned long long *hash) {
+    int nout = cube.part_size[cube.output];
+    int out0 = cube.first_part[cube.output];
+    int i, k;
+    pcube p;
+
+    foreachi_set(T, k, p) {
+        for (i = 0; i < nout; i++) {
+            if (is_in_set(p, out0 + i)) {
+                hash[i] = (hash[i] ^ (unsigned)k) * 0x100000001B3ULL;
+            }
+        }
+    }
+    for (i = 0; i < nout; i++) { /* mark the end of T */
+        hash[i] = (hash[i] ^ 0xFFFFFFFFULL) * 0x100000001B3ULL;
+    }
+}
+
+static unsigned long long *sort_hash;
+
+static int compare_hash(const void *a, const void *b) {
+    int i = *(const int *)a, j = *(const int *)b;
+
+    if (sort_hash[i] != sort_hash[j]) {
+        return sort_hash[i] < sort_hash[j] ? -1 : 1;
+    }
+    return i - j;
+}
+
+/*
+ *  find_duplicates -- fold each output into the first output with the
+ *  same column (if fold_outputs), setting rep and next_dup
+ */
+static void find_duplicates(partition_t *pt) {
+    int nout = cube.part_size[cube.output];
+    int *sorted, *last_dup, i, j, a, b;
+    unsigned long long *hash;
+
+    pt->rep = ALLOC(int, nout);
+    pt->next_dup = ALLOC(int, nout);
+    for (i = 0; i < nout; i++) {
+        pt->rep[i] = i;
+        pt->next_dup[i] = -1;
+    }
+    if (!fold_outputs) {
+        return;
+    }
+
+    hash = ALLOC(unsigned long long, nout);
+    sorted = ALLOC(int, nout);
+    last_dup = ALLOC(int, nout);
+    for (i = 0; i < nout; i++) {
+        hash[i] = 0xCBF29CE484222325ULL;
+        sorted[i] = last_dup[i] = i;
+    }
+    hash_columns(pt->F, hash);
+    hash_columns(pt->D, hash);
+    if (pt->R != NULL) {
+        hash_columns(pt->R, hash);
+    }
+
+    /* outputs with the same hash are adjacent, in increasing order */
+    sort_hash = hash;
+    qsort((char *)sorted, (size_t)nout, sizeof(int), compare_hash);
+    for (i = 0; i < nout; i++) {
+        b = sorted[i];
+        for (j = i - 1; j >= 0 && hash[sorted[j]] == hash[b]; j--) {
+            a = sorted[j];
+            if (pt->rep[a] == a && same_column(pt->F, a, b) &&
+                same_column(pt->D, a, b) &&
+                (pt->R == NULL || same_column(pt->R, a, b))) {
+                pt->rep[b] = a;
+                pt->next_dup[last_dup[a]] = b;
+                last_dup[a] = b;
+                break;
+            }
+        }
+    }
+
+    FREE(hash);
+    FREE(sorted);
+    FREE(last_dup);
+}
+
+/* find_components -- split the outputs of the function into components */
+static void find_components(partition_t *pt) {
+    int nout = cube.part_size[cube.output], nin = cube.num_binary_vars;
+    int *parent, *comp_of, i, k, r;
+    component_t *c;
+
+    parent = ALLOC(int, nout + nin);
+    for (i = 0; i < nout + nin; i++) {
+        parent[i] = i;
+    }
+    if (!partition_outputs) {
+        for (i = 1; i < nout; i++) {
+            if (pt->rep[i] == i) {
+                parent[i] = 0;
+            }
+        }
+    }
+    link_cubes(pt->F, parent, pt->rep);
+    link_cubes(pt->D, parent, pt->rep);
+    if (pt->R != NULL) {
+        link_cubes(pt->R, parent, pt->rep);
+    }
+
+    /* number the components in the order of their first output (folded
+       outputs are left out) */
+    comp_of = ALLOC(int, nout + nin);
+    pt->ncomp = 0;
+    for (i = 0; i < nout + nin; i++) {
+        comp_of[i] = -1;
+    }
+    for (i = 0; i < nout; i++) {
+        if (pt->rep[i] == i && uf_find(parent, i) == i) {
+            comp_of[i] = pt->ncomp++;
+        }
+    }
+
+    pt->comp = ALLOC(component_t, pt->ncomp);
+    for (k = 0; k < pt->ncomp; k++) {
+        pt->comp[k].ninputs = pt->comp[k].noutputs = pt->comp[k].cubes = 0;
+    }
+    for (i = 0; i < nout + nin; i++) {
+        if ((r = comp_of[uf_find(parent, i)]) != -1) {
+            if (i < nout) {
+                pt->comp[r].noutputs++;
+            } else {
+                pt->comp[r].ninputs++;
+            }
+        }
+    }
+    for (k = 0; k < pt->ncomp; k++) {
+        c = &pt->comp[k];
+        c->input = ALLOC(int, c->ninputs);
+        c->output = ALLOC(int, c->noutputs);
+        c->ninputs = c->noutputs = 0;
+    }
+    /* inputs without any literal belong to no component, and are dropped */
+    for (i = 0; i < nout + nin; i++) {
+        if ((r = comp_of[uf_find(parent, i)]) != -1) {
+            c = &pt->comp[r];
+            if (i < nout) {
+                c->output[c->noutputs++] = i;
+            } else {
+                c->input[c->ninputs++] = i - nout;
+            }
+        }
+    }
+
+    pt->comp_F = assign_cubes(pt->F, parent, comp_of, pt);
+    pt->comp_D = assign_cubes(pt->D, parent, comp_of, pt);
+    pt->comp_R = pt->R != NULL ? assign_cubes(pt->R, parent, comp_of, pt)
+                               : NIL(int);
+    FREE(parent);
+    FREE(comp_of);
+}
+
+/* project -- the cubes of T in component k, in the component's structure */
+static pcover project(partition_t *pt, pcover T, int *comp, int k) {
+    component_t *c = &pt->comp[k];
+    int out0 = cube.first_part[cube.output], i, j;
+    pcube p, q;
+    pcover T1;
+
+    T1 = new_cover(c->cubes);
+    foreachi_set(T, j, p) {
+        if (comp[j] == k) {
+            q = GETSET(T1, T1->count++);
+            (void)set_clear(q, cube.size);
+            for (i = 0; i < c->ninputs; i++) {
+                q[WHICH_WORD(2 * i)] |= GETINPUT(p, c->input[i])
+                                        << WHICH_BIT(2 * i);
+            }
+            for (i = 0; i < c->noutputs; i++) {
+                if (is_in_set(p, pt->first_output + c->output[i])) {
+                    set_insert(q, out0 + i);
+                }
+            }
+        }
+    }
+    return T1;
+}
+
+/* unproject -- the cubes of T (component k) in the full cube structure */
+static pcover unproject(partition_t *pt, pcover T, int k) {
+    component_t *c = &pt->comp[k];
+    int out0 = cube.first_part[cube.output], i, j, o;
+    pcube last, p, q;
+    pcover T1;
+
+    T1 = sf_new(T->count, pt->size);
+    foreach_set(T, last, p) {
+        q = GETSET(T1, T1->count++);
+        (void)set_clear(q, pt->size);
+        for (i = 0; i < 2 * pt->num_inputs; i++) {
+            set_insert(q, i);
+        }
+        for (i = 0; i < c->ninputs; i++) {
+            j = c->input[i];
+            q[WHICH_WORD(2 * j)] ^= (DASH ^ GETINPUT(p, i)) << WHICH_BIT(2 * j);
+        }
+        for (i = 0; i < c->noutputs; i++) {
+            if (is_in_set(p, out0 + i)) {
+                for (o = c->output[i]; o != -1; o = pt->next_dup[o]) {
+                    set_insert(q, pt->first_output + o);
+                }
+            }
+        }
+    }
+    return T1;
+}
+
+/* partition_run -- minimize the k-th largest component */
+static void partition_run(int n, void *data) {
+    partition_t *pt = data;
+    int k = pt->order[n], i;
+    component_t *c = &pt->comp[k];
+    struct cube_struct save_cube = cube;
+    struct cdata_struct save_cdata = cdata;
+    pcover F, D, R;
+
+    cube.num_binary_vars = c->ninputs;
+    cube.num_vars = c->ninputs + 1;
+    cube.part_size = ALLOC(int, cube.num_vars);
+    for (i = 0; i < c->ninputs; i++) {
+        cube.part_size[i] = 2;
+    }
+    cube.part_size[c->ninputs] = c->noutputs;
+    cube_setup();
+
+    F = project(pt, pt->F, pt->comp_F, k);
+    D = project(pt, pt->D, pt->comp_D, k);
+    if (pt->R != NULL) {
+        R = project(pt, pt->R, pt->comp_R, k);
+    } else if (!lazy_offset) {
+        R = compute_offset(F, D);
+    } else {
+        R = NULL;
+    }
+
+    /* the result must not depend on what ran before on this thread */
+    reduce_set_order(TRUE);
+    budget_truncated = FALSE;
+    if (F->count > 0) {
+        if (portfolio_size > 1) {
+            F = espresso_portfolio(F, D, R);
+        } else {
+            F = espresso(F, D, R);
+        }
+    }
+    pt->result[k] = unproject(pt, F, k);
+    pt->truncated[k] = budget_truncated;
+
+    free_cover(F);
+    free_cover(D);
+    if (R != NULL) {
+        free_cover(R);
+    }
+    FREE(cube.part_size);
+    setdown_cube();
+    cube = save_cube;
+    cdata = save_cdata;
+}
+
+/* minimize -- espresso() on the whole function, computing R if needed */
+static pcover minimize(pcover F, pcover D, pcover R) {
+    bool own_R = R == NULL && !lazy_offset;
+
+    if (own_R) {
+        R = compute_offset(F, D);
+    }
+    if (portfolio_size > 1) {
+        F = espresso_portfolio(F, D, R);
+    } else {
+        F = espresso(F, D, R);
+    }
+    if (own_R) {
+        free_cover(R);
+    }
+    return F;
+}
+
+/*
+ *  espresso_partition -- like espresso(), minimizing each independent
+ *  group of outputs (or just the support) separately; R may be NULL
+ */
+pcover espresso_partition(pcover F, pcover D, pcover R) {
+    partition_t pt;
+    int i, j, k;
+    bool truncated;
+    pcover F1;
+
+    if (cube.output == -1 || cube.num_vars != cube.num_binary_vars + 1) {
+        return minimize(F, D, R);
+    }
+
+    pt.F = F;
+    pt.D = D;
+    pt.R = R;
+    pt.size = cube.size;
+    pt.num_inputs = cube.num_binary_vars;
+    pt.first_output = cube.first_part[cube.output];
+    find_duplicates(&pt);
+    find_components(&pt);
+
+    if (pt.ncomp == 1 && pt.comp[0].ninputs == cube.num_binary_vars &&
+        pt.comp[0].noutputs == cube.part_size[cube.output]) {
+        F1 = minimize(F, D, R);
+    } else {
+        /* hand out the largest components first */
+        pt.order = ALLOC(int, pt.ncomp);
+        for (k = 0; k < pt.ncomp; k++) {
+            for (j = k; j > 0 && pt.comp[pt.order[j - 1]].cubes <
+                                     pt.comp[k].cubes; j--) {
+                pt.order[j] = pt.order[j - 1];
+            }
+            pt.order[j] = k;
+        }
+        pt.result = ALLOC(pcover, pt.ncomp);
+        pt.truncated = ALLOC(bool, pt.ncomp);
+
+        parallel_for(pt.ncomp, num_threads, partition_run, &pt);
+
+        F1 = new_cover(F->count);
+        truncated = FALSE;
+        for (k = 0; k < pt.ncomp; k++) {
+            F1 = sf_append(F1, pt.result[k]);
+            truncated |= pt.truncated[k];
+        }
+        budget_truncated = truncated;
+        free_cover(F); /* dispose of F, like espresso() does */
+        FREE(pt.order);
+        FREE(pt.result);
+        FREE(pt.truncated);
+    }
+
+    for (i = 0; i < pt.ncomp; i++) {
+        FREE(pt.comp[i].input);
+        FREE(pt.comp[i].output);
+    }
+    FREE(pt.comp);
+    FREE(pt.rep);
+    FREE(pt.next_dup);
+    FREE(pt.comp_F);
+    FREE(pt.comp_D);
+    if (pt.comp_R != NIL(int)) {
+        FREE(pt.comp_R);
+    }
+    return F1;
+}
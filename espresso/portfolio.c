@@ -0,0 +1,114 @@
+/*
+    module: portfolio.c
+    purpose: run several variants of espresso() concurrently
+
+    espresso_portfolio() minimizes the function with portfolio_size
+    variants of espresso(), each on its own thread, and returns the
+    cheapest of their covers (fewest cubes, then fewest literals, then the
+    lowest variant number).  The variants are:
+
+	0	espresso() as it is
+	1	without the unravel of the output part (unwrap_onset)
+	2, 3	as 0 and 1, but the first reduce() uses mini_sort ordering
+	4 ...	as 0 .. 3, with the cubes of F shuffled first (the seed is
+		variant / 4), which changes how ties are broken in the sorts
+
+    Variant 0 computes exactly what espresso() does, so the result is
+    never worse.  The variants share the time budget: once it has run out,
+    each of them stops at its next safe point, and the best of the covers
+    found so far is returned.
+*/
+
+#include "espresso.h"
+
+typedef struct {
+    pcover F, D, R;  /* the function (read only) */
+    pcover *result;  /* the cover found by each variant */
+    cost_t *cost;    /* and its cost */
+    bool *truncated; /* and whether its budget ran out */
+} portfolio_t;
+
+/* shuffle -- put the cubes of F in a pseudo-random order */
+static void shuffle(pcover F, unsigned int seed) {
+    unsigned long long state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    pcube temp = cube.temp[9];
+    int i, j;
+
+    for (i = F->count - 1; i > 0; i--) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        j = (int)((state >> 32) % (unsigned)(i + 1));
+        (void)set_copy(temp, GETSET(F, i));
+        (void)set_copy(GETSET(F, i), GETSET(F, j));
+        (void)set_copy(GETSET(F, j), temp);
+    }
+}
+
+static void portfolio_run(int variant, void *data) {
+    portfolio_t *pf = data;
+    pcover F, D, R;
+
+    F = sf_save(pf->F);
+    D = sf_save(pf->D);
+    R = pf->R != NULL ? sf_save(pf->R) : NULL;
+    unwrap_onset = variant % 2 == 0;
+    reduce_set_order(variant / 2 % 2 == 0);
+    if (variant >= 4) {
+        shuffle(F, (unsigned)(variant / 4));
+    }
+    budget_truncated = FALSE;
+
+    F = espresso(F, D, R);
+
+    cover_cost(F, &pf->cost[variant]);
+    pf->truncated[variant] = budget_truncated;
+    pf->result[variant] = F;
+    free_cover(D);
+    if (R != NULL) {
+        free_cover(R);
+    }
+
+    /* leave the defaults for whatever runs next on this thread */
+    unwrap_onset = TRUE;
+    reduce_set_order(TRUE);
+}
+
+/* espresso_portfolio -- like espresso(), using portfolio_size threads */
+pcover espresso_portfolio(pcover F, pcover D1, pcover R) {
+    portfolio_t pf;
+    int i, best;
+    pcost c, b;
+
+    pf.F = F;
+    pf.D = D1;
+    pf.R = R;
+    pf.result = ALLOC(pcover, portfolio_size);
+    pf.cost = ALLOC(cost_t, portfolio_size);
+    pf.truncated = ALLOC(bool, portfolio_size);
+
+    parallel_for(portfolio_size, portfolio_size, portfolio_run, &pf);
+
+    best = 0;
+    for (i = 1; i < portfolio_size; i++) {
+        c = &pf.cost[i];
+        b = &pf.cost[best];
+        if (c->cubes < b->cubes ||
+            (c->cubes == b->cubes && c->total < b->total)) {
+            best = i;
+        }
+    }
+    for (i = 0; i < portfolio_size; i++) {
+        if (i != best) {
+            free_cover(pf.result[i]);
+        }
+    }
+    budget_truncated = pf.truncated[best];
+    free_cover(F); /* dispose of F, like espresso() does */
+    F = pf.result[best];
+
+    FREE(pf.result);
+    FREE(pf.cost);
+    FREE(pf.truncated);
+    return F;
+}
@@ -9,7 +9,24 @@
 
 #include "espresso.h"
 
-static bool toggle = TRUE;
+/* most cubes of F reduced by each thread in one batch of reduce_parallel */
+#define REDUCE_BATCH 8
+/* smallest F u D for which reduce() uses several threads */
+#define REDUCE_PARALLEL_MIN 256
+
+static _Thread_local bool toggle = TRUE;
+
+static void reduce_parallel(pcover F, pcube *FD, int nthreads);
+
+/* reduce_set_order -- choose the ordering used by the next reduce() */
+void reduce_set_order(bool use_sort_reduce) {
+    toggle = use_sort_reduce;
+}
+
+/* reduce_get_order -- the ordering which the next reduce() will use */
+bool reduce_get_order() {
+    return toggle;
+}
 
 /*
     reduce -- replace each cube in F with its reduction
@@ -41,10 +58,30 @@ static bool toggle = TRUE;
     The SCCC of a unate cover is trivial to compute, and thus we perform
     Shannon Cofactor expansion attempting to drive the cover to be unate
     as fast as possible.
+
+    With num_threads > 1 and a large F u D, the cubes are reduced on
+    several threads (see reduce_parallel), with the same result.
 */
 
+/* reduce_accept -- replace p by cunder, its reduction; TRUE if it changed */
+static bool reduce_accept(pcube p, pcube cunder) {
+    if (setp_equal(cunder, p)) { /* see if it actually did */
+        SET(p, ACTIVE);          /* cube remains active */
+        SET(p, PRIME);           /* cube remains prime ? */
+        return FALSE;
+    }
+    set_copy(p, cunder); /* save reduced version */
+    RESET(p, PRIME);     /* cube is no longer prime */
+    if (setp_empty(cunder))
+        RESET(p, ACTIVE); /* if null, kill the cube */
+    else
+        SET(p, ACTIVE); /* cube is active */
+    return TRUE;
+}
+
 pcover reduce(pcover F, pcover D) {
     pcube last, p, cunder, *FD;
+    int nthreads;
 
     /* Order the cubes */
     F = toggle ? sort_reduce(F) : mini_sort(F, descend);
@@ -52,20 +89,15 @@ pcover reduce(pcover F, pcover D) {
 
     /* Try to reduce each cube */
     FD = cube2list(F, D);
-    foreach_set(F, last, p) {
-        cunder = reduce_cube(FD, p); /* reduce the cube */
-        if (setp_equal(cunder, p)) { /* see if it actually did */
-            SET(p, ACTIVE);          /* cube remains active */
-            SET(p, PRIME);           /* cube remains prime ? */
-        } else {
-            set_copy(p, cunder); /* save reduced version */
-            RESET(p, PRIME);     /* cube is no longer prime */
-            if (setp_empty(cunder))
-                RESET(p, ACTIVE); /* if null, kill the cube */
-            else
-                SET(p, ACTIVE); /* cube is active */
+    nthreads = MIN(parallel_threads(num_threads), F->count);
+    if (nthreads > 1 && CUBELISTSIZE(FD) >= REDUCE_PARALLEL_MIN) {
+        reduce_parallel(F, FD, nthreads);
+    } else {
+        foreach_set(F, last, p) {
+            cunder = reduce_cube(FD, p); /* reduce the cube */
+            (void)reduce_accept(p, cunder);
+            free_cube(cunder);
         }
-        free_cube(cunder);
     }
     free_cubelist(FD);
 
@@ -73,6 +105,104 @@ pcover reduce(pcover F, pcover D) {
     return sf_inactive(F);
 }
 
+/*
+    reduce_parallel -- the loop of reduce() on nthreads threads
+
+    The cubes are taken in batches of the next few cubes per thread (at
+    most REDUCE_BATCH), which are reduced concurrently against F u D as it
+    is at the start of the batch; nothing is written to F (or D) while
+    they are.  The reductions are then accepted in the order of F, as the
+    loop of reduce() would.
+
+    The reduction of p only looks at the cubes of F u D which intersect p
+    (cofactor drops the others).  A cube only gets smaller when it is
+    reduced, so if none of the cubes reduced since the start of the batch
+    intersected p before, the reduction of p is the one reduce() would
+    find, and is accepted.  Otherwise p is reduced again, on the calling
+    thread, against F as it is now.
+
+    The result is therefore the same as with a single thread.  The batches
+    are made smaller when many of the cubes of a batch had to be reduced
+    again, and larger again when few had.  The same threads reduce every
+    batch (see parallel_start).
+*/
+typedef struct {
+    pcover F;        /* the cubes to reduce (read only while reducing) */
+    pcube *FD;       /* the cube list of F u D */
+    int nslots;
+    int first, n;    /* the cubes of F reduced in this batch */
+    pcover cunder;   /* cunder[k] -- the reduction of cube first + k */
+} reduce_batch_t;
+
+static void reduce_speculate(int s, void *data) {
+    reduce_batch_t *rb = data;
+    pcube cunder;
+    int k;
+
+    for (k = s; k < rb->n; k += rb->nslots) {
+        cunder = reduce_cube(rb->FD, GETSET(rb->F, rb->first + k));
+        (void)set_copy(GETSET(rb->cunder, k), cunder);
+        free_cube(cunder);
+    }
+}
+
+static void reduce_parallel(pcover F, pcube *FD, int nthreads) {
+    reduce_batch_t rb;
+    struct parallel_team *team;
+    pcube p, q, last, cunder;
+    pcover changed;
+    bool valid;
+    int k, per_thread, wasted;
+
+    team = parallel_start(nthreads);
+    nthreads = parallel_size(team);
+    rb.F = F;
+    rb.FD = FD;
+    rb.nslots = nthreads;
+    rb.cunder = new_cover(nthreads * REDUCE_BATCH);
+    changed = new_cover(nthreads * REDUCE_BATCH);
+
+    per_thread = 1;
+    for (rb.first = 0; rb.first < F->count; rb.first += rb.n) {
+        rb.n = MIN(nthreads * per_thread, F->count - rb.first);
+        rb.cunder->count = rb.n;
+        parallel_run(team, reduce_speculate, &rb);
+
+        /* Accept the reductions in order; changed has the old cubes */
+        changed->count = 0;
+        wasted = 0;
+        for (k = 0; k < rb.n; k++) {
+            p = GETSET(F, rb.first + k);
+            valid = TRUE;
+            foreach_set(changed, last, q) {
+                if (cdist0(q, p)) {
+                    valid = FALSE;
+                    break;
+                }
+            }
+            (void)set_copy(GETSET(changed, changed->count), p);
+            if (valid) {
+                if (reduce_accept(p, GETSET(rb.cunder, k)))
+                    changed->count++;
+            } else {
+                wasted++;
+                cunder = reduce_cube(FD, p);
+                if (reduce_accept(p, cunder))
+                    changed->count++;
+                free_cube(cunder);
+            }
+        }
+        if (4 * wasted > rb.n)
+            per_thread = MAX(per_thread / 2, 1);
+        else
+            per_thread = MIN(per_thread * 2, REDUCE_BATCH);
+    }
+
+    parallel_stop(team);
+    free_cover(rb.cunder);
+    free_cover(changed);
+}
+
 /* reduce_cube -- find the maximal reduction of a cube */
 pcube reduce_cube(pcube *FD, pcube p) {
     pcube cunder;
@@ -3,7 +3,7 @@
  */
 
 #include "espresso.h"
-static pset_family set_family_garbage = NULL;
+static _Thread_local pset_family set_family_garbage = NULL;
 
 static void intcpy(unsigned int *d, unsigned int *s, long n) {
     int i;
@@ -18,6 +18,9 @@ pset do_sm_minimum_cover(pset_family A) {
         rownum++;
     }
 
+    if (capture_dir != NULL) {
+        capture_matrix("mincov", M, NIL(int), 1);
+    }
     sparse_cover = sm_minimum_cover(M, NIL(int), 1);
     sm_free(M);
 
@@ -11,6 +11,9 @@
 
 #include "espresso.h"
 
+/* smallest F for which mv_reduce() uses several threads */
+#define MV_REDUCE_PARALLEL_MIN 64
+
 pcover make_sparse(pcover F, pcover D, pcover R) {
     cost_t cost, best_cost;
 
@@ -22,7 +25,7 @@ pcover make_sparse(pcover F, pcover D, pcover R) {
             break;
         copy_cost(&cost, &best_cost);
 
-        F = expand(F, R, TRUE);
+        F = R != NULL ? expand(F, R, TRUE) : expand_lazy(F, D, TRUE);
         if (cost.total == best_cost.total)
             break;
         copy_cost(&cost, &best_cost);
@@ -43,69 +46,107 @@ pcover make_sparse(pcover F, pcover D, pcover R) {
     In normal use, it is expected that the cover is irredundant and
     hence no cubes will be reduced to the empty cube (however, this is
     checked for and such cubes will be deleted)
+
+    The irredundant problems for the parts of a variable do not depend on
+    each other (the cofactors ignore the other parts of the variable), so
+    with num_threads > 1 they are solved on several threads; the parts are
+    then removed from the cubes in order, as they would be one at a time.
 */
 
-pcover mv_reduce(pcover F, pcover D) {
-    int i, var;
-    pcube p, p1, last;
-    int index;
+typedef struct {
+    pcover F, D; /* the function (read only) */
+    int var;
+    int **redund; /* redund[k] -- the cubes of F redundant in part k of
+                     var (ending with -1) */
+} mv_reduce_t;
+
+/* mv_reduce_part -- find the cubes of F redundant in part k of var */
+static void mv_reduce_part(int k, void *data) {
+    mv_reduce_t *mv = data;
+    int i = cube.first_part[mv->var] + k, n, index;
+    pcube p, p1, last, mask = cube.var_mask[mv->var];
     pcover F1, D1;
-    pcube *F_cube_table;
+    int *F_index;
+
+    /* remember mapping of F1 cubes back to F cubes */
+    F_index = ALLOC(int, mv->F->count);
+
+    /* 'cofactor' against part #i of variable #var */
+    F1 = new_cover(mv->F->count);
+    foreachi_set(mv->F, index, p) {
+        if (is_in_set(p, i)) {
+            F_index[F1->count] = index;
+            p1 = GETSET(F1, F1->count++);
+            (void)set_diff(p1, p, mask);
+            set_insert(p1, i);
+        }
+    }
+
+    /* 'cofactor' against part #i of variable #var */
+    /* not really necessary -- just more efficient ? */
+    D1 = new_cover(mv->D->count);
+    foreach_set(mv->D, last, p) {
+        if (is_in_set(p, i)) {
+            p1 = GETSET(D1, D1->count++);
+            (void)set_diff(p1, p, mask);
+            set_insert(p1, i);
+        }
+    }
+
+    mark_irredundant(F1, D1);
+
+    /* list the cubes which are redundant */
+    mv->redund[k] = ALLOC(int, F1->count + 1);
+    n = 0;
+    foreachi_set(F1, index, p1) {
+        if (!TESTP(p1, ACTIVE)) {
+            mv->redund[k][n++] = F_index[index];
+        }
+    }
+    mv->redund[k][n] = -1;
+
+    free_cover(F1);
+    free_cover(D1);
+    FREE(F_index);
+}
+
+pcover mv_reduce(pcover F, pcover D) {
+    int i, k, var;
+    int *index;
+    pcube p, last;
+    mv_reduce_t mv;
+
+    mv.F = F;
+    mv.D = D;
 
     /* loop for each multiple-valued variable */
     for (var = 0; var < cube.num_vars; var++) {
         if (cube.sparse[var]) {
-            /* loop for each part of the variable */
-            for (i = cube.first_part[var]; i <= cube.last_part[var]; i++) {
-                /* remember mapping of F1 cubes back to F cubes */
-                F_cube_table = ALLOC(pcube, F->count);
-
-                /* 'cofactor' against part #i of variable #var */
-                F1 = new_cover(F->count);
-                foreach_set(F, last, p) {
-                    if (is_in_set(p, i)) {
-                        F_cube_table[F1->count] = p;
-                        p1 = GETSET(F1, F1->count++);
-                        (void)set_diff(p1, p, cube.var_mask[var]);
-                        set_insert(p1, i);
-                    }
-                }
-
-                /* 'cofactor' against part #i of variable #var */
-                /* not really necessary -- just more efficient ? */
-                D1 = new_cover(D->count);
-                foreach_set(D, last, p) {
-                    if (is_in_set(p, i)) {
-                        p1 = GETSET(D1, D1->count++);
-                        (void)set_diff(p1, p, cube.var_mask[var]);
-                        set_insert(p1, i);
-                    }
-                }
-
-                mark_irredundant(F1, D1);
-
-                /* now remove part i from cubes which are redundant */
-                index = 0;
-                foreach_set(F1, last, p1) {
-                    if (!TESTP(p1, ACTIVE)) {
-                        p = F_cube_table[index];
-
-                        /*   don't reduce a variable which is full
-                         *   (unless it is the output variable)
-                         */
-                        if (var == cube.num_vars - 1 ||
-                            !setp_implies(cube.var_mask[var], p)) {
-                            set_remove(p, i);
-                        }
-                        RESET(p, PRIME);
+            /* find the redundant cubes for each part of the variable */
+            mv.var = var;
+            mv.redund = ALLOC(int *, cube.part_size[var]);
+            parallel_for(cube.part_size[var],
+                         F->count >= MV_REDUCE_PARALLEL_MIN ? num_threads : 1,
+                         mv_reduce_part, &mv);
+
+            /* now remove part i from cubes which are redundant */
+            for (k = 0; k < cube.part_size[var]; k++) {
+                i = cube.first_part[var] + k;
+                for (index = mv.redund[k]; *index >= 0; index++) {
+                    p = GETSET(F, *index);
+
+                    /*   don't reduce a variable which is full
+                     *   (unless it is the output variable)
+                     */
+                    if (var == cube.num_vars - 1 ||
+                        !setp_implies(cube.var_mask[var], p)) {
+                        set_remove(p, i);
                     }
-                    index++;
+                    RESET(p, PRIME);
                 }
-
-                free_cover(F1);
-                free_cover(D1);
-                FREE(F_cube_table);
+                FREE(mv.redund[k]);
             }
+            FREE(mv.redund);
         }
     }
 
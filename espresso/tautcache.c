@@ -0,0 +1,203 @@
+/*
+    module: tautcache.c
+    purpose: remember the answers of tautology()
+
+    The tautology questions asked by irredundant, essential and mv_reduce
+    are about cube lists drawn from the same F u D, and the recursion of
+    tautology() often comes to the same cofactors again, within one step
+    and from one iteration of espresso() to the next.
+
+    Whether a cube list T is a tautology only depends on the cubes p | T[0]
+    (p in T), in any order.  With taut_cache set, tautology() looks these
+    cubes up first (by a hash which does not depend on their order), and
+    when the answer is not known yet it is added once found.  The cubes
+    themselves are kept and compared, so an answer is never taken for a
+    different list; only lists of at least TAUT_CACHE_MIN cubes are kept,
+    and the least recently used ones are dropped when more than
+    TAUT_CACHE_WORDS words are kept.
+
+    The cache belongs to the thread, and is emptied whenever the cube
+    structure is set up or released (the same words mean something else
+    under another structure).
+*/
+
+#include "espresso.h"
+
+/* smallest cube list remembered */
+#define TAUT_CACHE_MIN 64
+/* most words of cubes remembered by each thread */
+#define TAUT_CACHE_WORDS (1L << 22)
+/* hash buckets (a power of 2) */
+#define TAUT_CACHE_BUCKETS (1 << 16)
+
+typedef struct taut_entry {
+    struct taut_entry *next;          /* in its bucket */
+    struct taut_entry *older, *newer; /* in the order of use */
+    unsigned long long hash;
+    int n;              /* cubes in key */
+    int result;         /* TRUE or FALSE, once known */
+    bool sorted;        /* whether key is in sorted order yet */
+    unsigned int *key;  /* the cubes p | T[0]; words 1 .. LOOP of each */
+} taut_entry_t;
+
+static _Thread_local taut_entry_t **bucket;
+static _Thread_local taut_entry_t *oldest, *newest;
+static _Thread_local long words_kept;
+static _Thread_local int key_words; /* words of each cube in a key */
+
+
+static int key_order(const void *a, const void *b) {
+    const unsigned int *p = a, *q = b;
+    int i;
+
+    for (i = 0; i < key_words; i++) {
+        if (p[i] != q[i]) {
+            return p[i] < q[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/* sort_key -- put the cubes of the key of e in sorted order */
+static void sort_key(taut_entry_t *e) {
+    if (!e->sorted) {
+        qsort(e->key, e->n, key_words * sizeof(unsigned int), key_order);
+        e->sorted = TRUE;
+    }
+}
+
+/*
+ *  same_key -- TRUE if the keys of e and f have the same cubes; they are
+ *  usually in the same order too (the cofactors keep the order of F u D),
+ *  and only sorted when they are not
+ */
+static bool same_key(taut_entry_t *e, taut_entry_t *f) {
+    size_t size = e->n * key_words * sizeof(unsigned int);
+
+    if (memcmp(e->key, f->key, size) == 0)
+        return TRUE;
+    if (e->sorted && f->sorted)
+        return FALSE;
+    sort_key(e);
+    sort_key(f);
+    return memcmp(e->key, f->key, size) == 0;
+}
+
+/* lru_unlink -- take e out of the order of use */
+static void lru_unlink(taut_entry_t *e) {
+    if (e->older != NULL) {
+        e->older->newer = e->newer;
+    } else {
+        oldest = e->newer;
+    }
+    if (e->newer != NULL) {
+        e->newer->older = e->older;
+    } else {
+        newest = e->older;
+    }
+}
+
+/* lru_newest -- put e last in the order of use */
+static void lru_newest(taut_entry_t *e) {
+    e->older = newest;
+    e->newer = NULL;
+    if (newest != NULL) {
+        newest->newer = e;
+    } else {
+        oldest = e;
+    }
+    newest = e;
+}
+
+static void free_entry(taut_entry_t *e) {
+    FREE(e->key);
+    FREE(e);
+}
+
+/* drop_oldest -- forget the least recently used answer */
+static void drop_oldest() {
+    taut_entry_t *e = oldest, **pe;
+
+    for (pe = &bucket[e->hash & (TAUT_CACHE_BUCKETS - 1)]; *pe != e;
+         pe = &(*pe)->next)
+        ;
+    *pe = e->next;
+    lru_unlink(e);
+    words_kept -= (long)e->n * key_words;
+    free_entry(e);
+}
+
+/*
+ *  taut_cache_lookup -- the answer for T if it is known (TRUE or FALSE),
+ *  or MAYBE; then *pending is what taut_cache_store() needs to remember
+ *  the answer (or NULL if T is too small to be kept)
+ */
+int taut_cache_lookup(pcube *T, void **pending) {
+    taut_entry_t *e, *f;
+    pcube p, cof = T[0], *T1;
+    unsigned int *k;
+    unsigned long long h;
+    int i, n = CUBELISTSIZE(T);
+
+    *pending = NULL;
+    if (n < TAUT_CACHE_MIN) {
+        return MAYBE;
+    }
+    if (bucket == NULL) {
+        bucket = ALLOC(taut_entry_t *, TAUT_CACHE_BUCKETS);
+        for (i = 0; i < TAUT_CACHE_BUCKETS; i++) {
+            bucket[i] = NULL;
+        }
+    }
+    key_words = LOOP(cube.fullset);
+
+    /* The key: the cubes p | T[0], hashed in any order */
+    e = ALLOC(taut_entry_t, 1);
+    e->n = n;
+    e->sorted = FALSE;
+    e->key = k = ALLOC(unsigned int, n * key_words);
+    e->hash = n;
+    for (T1 = T + 2; (p = *T1++) != NULL;) {
+        h = 0xcbf29ce484222325ULL;
+        for (i = 1; i <= key_words; i++) {
+            *k = p[i] | cof[i];
+            h = (h ^ *k++) * 0x100000001b3ULL;
+        }
+        e->hash += h ^ h >> 29;
+    }
+
+    for (f = bucket[e->hash & (TAUT_CACHE_BUCKETS - 1)]; f != NULL;
+         f = f->next) {
+        if (f->hash == e->hash && f->n == n && same_key(e, f)) {
+            free_entry(e);
+            lru_unlink(f);
+            lru_newest(f);
+            return f->result;
+        }
+    }
+    *pending = e;
+    return MAYBE;
+}
+
+/* taut_cache_store -- remember the answer for a lookup which missed */
+void taut_cache_store(void *pending, int result) {
+    taut_entry_t *e = pending, **b;
+
+    e->result = result;
+    b = &bucket[e->hash & (TAUT_CACHE_BUCKETS - 1)];
+    e->next = *b;
+    *b = e;
+    lru_newest(e);
+    words_kept += (long)e->n * key_words;
+    while (words_kept > TAUT_CACHE_WORDS && oldest != e) {
+        drop_oldest();
+    }
+}
+
+/* taut_cache_flush -- forget every answer (of this thread) */
+void taut_cache_flush() {
+    while (oldest != NULL) {
+        drop_oldest();
+    }
+    FREE(bucket);
+}
@@ -4,6 +4,8 @@
 
 #include "espresso.h"
 
+static pset_family unate_dual(pset_family A);
+
 pcover map_cover_to_unate(pcube *T) {
     unsigned int word_test, word_set, bit_test, bit_set;
     pcube p, pA;
@@ -94,20 +96,16 @@ pcover map_unate_to_cover(pset_family A) {
  */
 
 pset_family unate_compl(pset_family A) {
-    pset p, last;
-
-    /* Make sure A is single-cube containment minimal */
-    /*    A = sf_rev_contain(A);*/
-
-    foreach_set(A, last, p) {
-        PUTSIZE(p, set_ord(p));
-    }
+    pset_family Abar;
+    pset *A1;
 
     /* Recursively find the complement */
-    A = unate_complement(A);
+    Abar = unate_dual(A);
 
-    /* Now, we can guarantee a minimal result by containing the result */
-    A = sf_rev_contain(A);
+    /* The sets are minimal and distinct; put them in increasing size */
+    A1 = sf_sort(Abar, ascend);
+    A = sf_unlist(A1, Abar->count, Abar->sf_size);
+    sf_free(Abar);
     return A;
 }
 
@@ -175,6 +173,226 @@ static int abs_select_restricted(pset_family A, pset _restrict) {
     return best_var;
 }
 
+/*
+ *  unate_dual -- the minimal sets of columns which meet every set of A (the
+ *  complement, as unate_complement finds it before sf_rev_contain), with
+ *  the same choice of columns, but without a copy of the matrix at each
+ *  step:
+ *
+ *  The sets of A stay where they are.  The ones still to be met are kept
+ *  first in the array row (and are just reordered to pick the ones a
+ *  column does not meet), the columns which may no longer be chosen are in
+ *  excl, and the number of other columns of each set in its size, which
+ *  is put back when the column is allowed again.
+ *
+ *  Each column is either chosen or excluded, so no set is found twice, and
+ *  a set which is not minimal is dropped as it is found (see dual_minimal)
+ *  rather than by a containment check of all of them at the end.
+ */
+typedef struct {
+    pset set;
+    int size; /* columns of set which are not in excl */
+} dual_row_t;
+
+typedef struct {
+    dual_row_t *row;
+    pset path;             /* the columns chosen so far */
+    pset excl;             /* the columns which may not be chosen */
+    int nrows;
+    pset crit;             /* scratch set for dual_minimal */
+    pset_family restrict_; /* one set of columns for each depth */
+    int *count;            /* column counts (see abs_select_restricted) */
+    pset_family Abar;      /* the sets found */
+} dual_t;
+
+/* dual_front -- move the rows among the first n which miss cols to the
+   front; returns how many there are */
+static int dual_front(dual_t *d, int n, pset cols) {
+    dual_row_t *r = d->row, t;
+    int k, m = 0;
+
+    for (k = 0; k < n; k++) {
+        if (setp_disjoint(r[k].set, cols)) {
+            t = r[k], r[k] = r[m], r[m++] = t;
+        }
+    }
+    return m;
+}
+
+/* dual_select -- abs_select_restricted for the first n rows */
+static int dual_select(dual_t *d, int n, pset _restrict) {
+    dual_row_t *r = d->row;
+    int i, k, base, weight, best_var, best_count, *count = d->count;
+    unsigned int val;
+
+    for (i = 0; i < d->Abar->sf_size; i++) {
+        count[i] = 0;
+    }
+    for (k = 0; k < n; k++) {
+        weight = 1024 / (r[k].size - 1);
+        for (i = LOOP(_restrict); i > 0;) {
+            for (val = r[k].set[i] & _restrict[i], base = --i << LOGBPI;
+                 val != 0; base++, val >>= 1) {
+                if (val & 1) {
+                    count[base] += weight;
+                }
+            }
+        }
+    }
+
+    best_var = -1;
+    best_count = 0;
+    for (i = 0; i < d->Abar->sf_size; i++) {
+        if (count[i] > best_count) {
+            best_var = i;
+            best_count = count[i];
+        }
+    }
+    if (best_var == -1)
+        fatal("unate_dual: should not have best_var == -1");
+    return best_var;
+}
+
+/*
+ *  dual_minimal -- TRUE if path (which meets every set of A) is minimal:
+ *  each of its columns is the only one of path in some set of A
+ */
+static bool dual_minimal(dual_t *d) {
+    pset p, crit = d->crit;
+    int i, k, col;
+    unsigned int x;
+
+    (void)set_clear(crit, d->Abar->sf_size);
+    for (k = 0; k < d->nrows; k++) {
+        p = d->row[k].set;
+        col = -1;
+        for (i = LOOP(p); i > 0; i--) {
+            if ((x = p[i] & d->path[i]) != 0) {
+                if (col >= 0 || (x & (x - 1)) != 0)
+                    break;
+                col = (i - 1) * BPI;
+                while ((x & 1) == 0)
+                    x >>= 1, col++;
+            }
+        }
+        if (i == 0 && col >= 0)
+            set_insert(crit, col);
+    }
+    return setp_equal(crit, d->path);
+}
+
+/* dual_add -- add path to the sets found, if it is minimal */
+static void dual_add(dual_t *d) {
+    if (dual_minimal(d))
+        d->Abar = sf_addset(d->Abar, d->path);
+}
+
+/* dual_rec -- the sets which meet the first n rows, added to path */
+static void dual_rec(dual_t *d, int n, int depth) {
+    dual_row_t *r = d->row;
+    pset _restrict = GETSET(d->restrict_, depth);
+    int i, k, m, min_set_ord;
+
+    /* No sets left -- the columns chosen are one of the sets */
+    if (n == 0) {
+        dual_add(d);
+        return;
+    }
+
+    /* A single set -- each of its columns completes path */
+    if (n == 1) {
+        for (i = 0; i < d->Abar->sf_size; i++) {
+            if (is_in_set(r[0].set, i) && !is_in_set(d->excl, i)) {
+                set_insert(d->path, i);
+                dual_add(d);
+                set_remove(d->path, i);
+            }
+        }
+        return;
+    }
+
+    /* The columns of the smallest sets */
+    min_set_ord = d->Abar->sf_size + 1;
+    for (k = 0; k < n; k++) {
+        if (r[k].size < min_set_ord) {
+            (void)set_copy(_restrict, r[k].set);
+            min_set_ord = r[k].size;
+        } else if (r[k].size == min_set_ord) {
+            (void)set_or(_restrict, _restrict, r[k].set);
+        }
+    }
+    (void)set_diff(_restrict, _restrict, d->excl);
+
+    if (min_set_ord == 0) {
+        /* A set which cannot be met */
+        return;
+
+    } else if (min_set_ord == 1) {
+        /* "Essential" columns must all be chosen */
+        (void)set_or(d->path, d->path, _restrict);
+        dual_rec(d, dual_front(d, n, _restrict), depth + 1);
+        (void)set_diff(d->path, d->path, _restrict);
+
+    } else {
+        i = dual_select(d, n, _restrict);
+
+        /* Choose column i, and meet the sets it misses */
+        set_insert(d->path, i);
+        (void)set_clear(_restrict, d->Abar->sf_size);
+        set_insert(_restrict, i);
+        m = dual_front(d, n, _restrict);
+        dual_rec(d, m, depth + 1);
+        set_remove(d->path, i);
+
+        /* Then do without column i */
+        set_insert(d->excl, i);
+        for (k = 0; k < n; k++) {
+            if (is_in_set(r[k].set, i)) {
+                r[k].size--;
+            }
+        }
+        dual_rec(d, n, depth + 1);
+        for (k = 0; k < n; k++) {
+            if (is_in_set(r[k].set, i)) {
+                r[k].size++;
+            }
+        }
+        set_remove(d->excl, i);
+    }
+}
+
+static pset_family unate_dual(pset_family A /* disposes of A */
+) {
+    dual_t d;
+    pset p;
+    int i;
+
+    d.row = ALLOC(dual_row_t, A->count + 1);
+    foreachi_set(A, i, p) {
+        d.row[i].set = p;
+        d.row[i].size = set_ord(p);
+    }
+    d.nrows = A->count;
+    d.path = set_new(A->sf_size);
+    d.excl = set_new(A->sf_size);
+    d.crit = set_new(A->sf_size);
+    /* each step chooses or excludes a column */
+    d.restrict_ = sf_new(A->sf_size + 2, A->sf_size);
+    d.count = ALLOC(int, A->sf_size);
+    d.Abar = sf_new(A->count, A->sf_size);
+
+    dual_rec(&d, A->count, 0);
+
+    FREE(d.row);
+    set_free(d.path);
+    set_free(d.excl);
+    set_free(d.crit);
+    sf_free(d.restrict_);
+    FREE(d.count);
+    sf_free(A);
+    return d.Abar;
+}
+
 /*
  *  Assume SIZE(p) records the size of each set
  */
@@ -0,0 +1,103 @@
+/*
+    module: verify.c
+    purpose: check a cover against the function it was minimized from
+
+    espresso -v file reads the PLA in file, and then a cover of the same
+    size (the result of espresso) from stdin.  The cover is correct if it
+    is contained in the ON-set and DC-set of the PLA (so it does not meet
+    the OFF-set), and contains the ON-set of the PLA up to the DC-set.
+    A correct cover is reported by its number of cubes and literals (as
+    counted by cover_cost), so that the results of different options can
+    be compared.
+*/
+
+#include "espresso.h"
+
+/* verify -- TRUE if F is a cover of Fold, with the DC-set Dold */
+bool verify(pcover F, pcover Fold, pcover Dold) {
+    pcube p, last, *T;
+    int extra = 0, missing = 0;
+
+    /* Each cube of F must be in Fold u Dold */
+    T = cube2list(Fold, Dold);
+    foreach_set(F, last, p) {
+        if (!cube_is_covered(T, p)) {
+            extra++;
+        }
+    }
+    free_cubelist(T);
+
+    /* Each cube of Fold must be in F u Dold */
+    T = cube2list(F, Dold);
+    foreach_set(Fold, last, p) {
+        if (!cube_is_covered(T, p)) {
+            missing++;
+        }
+    }
+    free_cubelist(T);
+
+    if (extra > 0) {
+        fprintf(stderr, "verify: %d cubes are not in the ON-set or DC-set\n",
+                extra);
+    }
+    if (missing > 0) {
+        fprintf(stderr, "verify: %d cubes of the ON-set are not covered\n",
+                missing);
+    }
+    return extra == 0 && missing == 0;
+}
+
+/*
+ *  verify_pla -- check the cover on fp against the PLA in the file fname;
+ *  returns the exit status of espresso -v (0 if the cover is correct)
+ */
+int verify_pla(char *fname, FILE *fp) {
+    pPLA PLA, result;
+    FILE *fin;
+    cost_t cost;
+    int *part_size, num_vars, var, status;
+
+    if ((fin = fopen(fname, "r")) == NULL) {
+        fprintf(stderr, "verify: cannot open %s\n", fname);
+        return 2;
+    }
+    if (read_pla(fin, FALSE, &PLA) == EOF) {
+        fprintf(stderr, "verify: unable to find PLA in %s\n", fname);
+        return 2;
+    }
+    (void)fclose(fin);
+
+    /*
+     *  Read the cover with a cube structure of its own, and check that it
+     *  is the same (the covers of PLA remain valid under it)
+     */
+    num_vars = cube.num_vars;
+    part_size = cube.part_size;
+    setdown_cube();
+    cube.part_size = NIL(int);
+    if (read_pla(fp, FALSE, &result) == EOF) {
+        fprintf(stderr, "verify: unable to find PLA on stdin\n");
+        return 2;
+    }
+    if (cube.num_vars != num_vars) {
+        fprintf(stderr, "verify: the PLAs have different sizes\n");
+        return 2;
+    }
+    for (var = 0; var < num_vars; var++) {
+        if (cube.part_size[var] != part_size[var]) {
+            fprintf(stderr, "verify: the PLAs have different sizes\n");
+            return 2;
+        }
+    }
+    FREE(part_size);
+
+    status = 1;
+    if (verify(result->F, PLA->F, PLA->D)) {
+        cover_cost(result->F, &cost);
+        printf("%d cubes %d literals\n", cost.cubes, cost.total);
+        status = 0;
+    }
+    free_PLA(PLA);
+    free_PLA(result);
+    return status;
+}